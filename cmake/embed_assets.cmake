@@ -0,0 +1,37 @@
+# writes OUTPUT, a translation unit holding every file in the images, sounds and fonts
+# directories of RESOURCE_DIR as a byte array, plus the table that src/assets.cpp looks them
+# up in. run with cmake -P so the arrays are regenerated whenever an asset changes.
+
+file(GLOB_RECURSE ASSETS RELATIVE "${RESOURCE_DIR}" "${RESOURCE_DIR}/images/*" "${RESOURCE_DIR}/sounds/*"
+    "${RESOURCE_DIR}/fonts/*")
+list(SORT ASSETS)
+
+set(declarations "")
+set(entries "")
+set(index 0)
+
+foreach(asset IN LISTS ASSETS)
+    file(READ "${RESOURCE_DIR}/${asset}" contents HEX)
+    file(SIZE "${RESOURCE_DIR}/${asset}" size)
+
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${contents}")
+    # keep the generated lines a sensible length.
+    string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],){24})" "\\1\n    " bytes "${bytes}")
+
+    string(APPEND declarations "const unsigned char ASSET_${index}[] = {\n    ${bytes}0x00};\n\n")
+    string(APPEND entries "    {\"${asset}\", ASSET_${index}, ${size}},\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT}.tmp"
+    "// generated by cmake/embed_assets.cmake, do not edit.\n\n"
+    "#include \"assets.hpp\"\n\n"
+    "namespace {\n\n"
+    "${declarations}"
+    "} // namespace\n\n"
+    "const EmbeddedAsset EMBEDDED_ASSETS[] = {\n${entries}};\n\n"
+    "const std::size_t EMBEDDED_ASSET_COUNT = ${index};\n")
+
+# only touch the output when it changed, so an unrelated rebuild does not recompile it.
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,27 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+// counts every global operator new in the process; allocationcounter.cpp replaces the
+// global allocation functions of whichever binary it is linked into.
+class AllocationCounter {
+public:
+    static std::uint64_t getCount();
+};
+
+// allocations made between construction and getAllocations(), e.g. around a generator call.
+class AllocationScope {
+public:
+    AllocationScope()
+        : m_start(AllocationCounter::getCount()) {}
+
+    std::uint64_t getAllocations() const {
+        return AllocationCounter::getCount() - m_start;
+    }
+
+private:
+    std::uint64_t m_start;
+};
+
+#endif
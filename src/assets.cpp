@@ -0,0 +1,74 @@
+#include "assets.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const std::filesystem::path RESOURCE_DIRECTORY = "resources";
+
+} // namespace
+
+Asset::Asset()
+    : m_embedded(nullptr)
+    , m_size(0) {}
+
+Asset Asset::load(const std::string& path) {
+    Asset asset;
+
+#ifdef CHESS_EMBED_ASSETS
+    for (std::size_t i = 0; i < EMBEDDED_ASSET_COUNT; ++i) {
+        if (path == EMBEDDED_ASSETS[i].path) {
+            asset.m_embedded = EMBEDDED_ASSETS[i].data;
+            asset.m_size = EMBEDDED_ASSETS[i].size;
+            return asset;
+        }
+    }
+
+    std::cerr << "Asset " << path << " is not embedded" << std::endl;
+#else
+    std::ifstream file(RESOURCE_DIRECTORY / path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Failed to open " << (RESOURCE_DIRECTORY / path).string() << std::endl;
+        return asset;
+    }
+
+    asset.m_storage.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(asset.m_storage.data()), static_cast<std::streamsize>(asset.m_storage.size()))) {
+        std::cerr << "Failed to read " << (RESOURCE_DIRECTORY / path).string() << std::endl;
+        asset.m_storage.clear();
+    }
+    asset.m_size = asset.m_storage.size();
+#endif
+
+    return asset;
+}
+
+std::vector<std::string> listAssets(const std::string& directory) {
+    std::vector<std::string> paths;
+
+#ifdef CHESS_EMBED_ASSETS
+    const std::string prefix = directory + "/";
+    for (std::size_t i = 0; i < EMBEDDED_ASSET_COUNT; ++i) {
+        std::string path = EMBEDDED_ASSETS[i].path;
+        if (path.compare(0, prefix.size(), prefix) == 0 && path.find('/', prefix.size()) == std::string::npos) {
+            paths.push_back(path);
+        }
+    }
+#else
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(RESOURCE_DIRECTORY / directory, error)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(directory + "/" + entry.path().filename().string());
+        }
+    }
+
+    if (error) {
+        std::cerr << "Failed to list " << (RESOURCE_DIRECTORY / directory).string() << ": " << error.message() << std::endl;
+    }
+#endif
+
+    return paths;
+}
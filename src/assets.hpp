@@ -0,0 +1,51 @@
+#ifndef ASSETS_HPP
+#define ASSETS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// a file compiled into the executable by the CHESS_EMBED_ASSETS build option.
+struct EmbeddedAsset {
+    const char* path;
+    const unsigned char* data;
+    std::size_t size;
+};
+
+#ifdef CHESS_EMBED_ASSETS
+// generated into the build directory by cmake/embed_assets.cmake.
+extern const EmbeddedAsset EMBEDDED_ASSETS[];
+extern const std::size_t EMBEDDED_ASSET_COUNT;
+#endif
+
+// the bytes of a file under resources/, e.g. "images/white-pawn.png". embedded assets are used
+// in place without a copy; otherwise the file is read from disk. no SDL, so assets can be
+// loaded and handed to decoders on any thread.
+class Asset {
+public:
+    Asset();
+
+    static Asset load(const std::string& path);
+
+    bool isLoaded() const {
+        return getData() != nullptr;
+    }
+
+    const unsigned char* getData() const {
+        return m_embedded ? m_embedded : (m_storage.empty() ? nullptr : m_storage.data());
+    }
+
+    std::size_t getSize() const {
+        return m_size;
+    }
+
+private:
+    const unsigned char* m_embedded;
+    std::vector<unsigned char> m_storage;
+    std::size_t m_size;
+};
+
+// paths of the assets directly inside directory, relative to resources/ like Asset::load takes.
+std::vector<std::string> listAssets(const std::string& directory);
+
+#endif
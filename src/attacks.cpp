@@ -0,0 +1,215 @@
+#include "attacks.hpp"
+
+#if !defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+#    define ATTACKS_RUNTIME_PEXT
+#    include <immintrin.h>
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#    endif
+#endif
+
+namespace detail {
+
+SliderMagic BISHOP_MAGICS[64];
+SliderMagic ROOK_MAGICS[64];
+Bitboard BETWEEN[64][64];
+Bitboard LINE[64][64];
+
+#if !defined(__BMI2__)
+bool usePext = false;
+
+#    if defined(ATTACKS_RUNTIME_PEXT) && (defined(__GNUC__) || defined(__clang__))
+__attribute__((target("bmi2")))
+#    endif
+unsigned pextIndex(Bitboard occupied, Bitboard mask) {
+#    if defined(ATTACKS_RUNTIME_PEXT)
+    return static_cast<unsigned>(_pext_u64(occupied, mask));
+#    else
+    (void)occupied;
+    (void)mask;
+    return 0;
+#    endif
+}
+#endif
+
+} // namespace detail
+
+bool isUsingPext() {
+#if defined(__BMI2__)
+    return true;
+#else
+    return detail::usePext;
+#endif
+}
+
+namespace {
+
+Bitboard bishopTable[0x1480];
+Bitboard rookTable[0x19000];
+
+constexpr int BISHOP_DIRECTIONS[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+constexpr int ROOK_DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+// slow reference generator, only used to fill the tables.
+Bitboard rayAttacks(int square, Bitboard occupied, const int (&directions)[4][2]) {
+    Bitboard attacks = 0;
+
+    for (const auto& direction : directions) {
+        int rank = squareRank(square);
+        int file = squareCol(square);
+
+        while (true) {
+            rank += direction[0];
+            file += direction[1];
+
+            if (rank < 0 || rank > 7 || file < 0 || file > 7) {
+                break;
+            }
+
+            Bitboard bit = squareBit(rank * 8 + file);
+            attacks |= bit;
+
+            if (occupied & bit) {
+                break;
+            }
+        }
+    }
+
+    return attacks;
+}
+
+#if !defined(__BMI2__)
+bool cpuSupportsBmi2() {
+#if defined(ATTACKS_RUNTIME_PEXT) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#elif defined(ATTACKS_RUNTIME_PEXT) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 8)) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+// xorshift64* with fixed seeds so the magic search is deterministic and quick.
+class MagicRandom {
+public:
+    explicit MagicRandom(std::uint64_t seed)
+        : m_state(seed) {}
+
+    std::uint64_t next() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 2685821657736338717ULL;
+    }
+
+    std::uint64_t sparse() {
+        return next() & next() & next();
+    }
+
+private:
+    std::uint64_t m_state;
+};
+
+void initSlider(SliderMagic* magics, Bitboard* table, const int (&directions)[4][2]) {
+    // seeds per rank that find a magic for every square within a few thousand tries.
+    const std::uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+    Bitboard occupancy[4096];
+    Bitboard reference[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+
+    Bitboard* slice = table;
+
+    for (int square = 0; square < 64; ++square) {
+        // edges only matter when the slider stands on them.
+        Bitboard edges = ((RANK_1 | RANK_8) & ~(RANK_1 << (8 * squareRank(square)))) |
+                         ((FILE_A | FILE_H) & ~(FILE_A << squareCol(square)));
+
+        SliderMagic& magic = magics[square];
+        magic.mask = rayAttacks(square, 0, directions) & ~edges;
+        magic.shift = 64 - popCount(magic.mask);
+        magic.attacks = slice;
+
+        int size = 0;
+        Bitboard subset = 0;
+        do {
+            occupancy[size] = subset;
+            reference[size] = rayAttacks(square, subset, directions);
+            if (isUsingPext()) {
+                slice[detail::sliderIndex(magic, subset)] = reference[size];
+            }
+            ++size;
+            subset = (subset - magic.mask) & magic.mask;
+        } while (subset);
+
+        slice += size;
+
+        if (isUsingPext()) {
+            continue;
+        }
+
+        MagicRandom random(seeds[squareRank(square)]);
+
+        for (int i = 0; i < size;) {
+            magic.magic = 0;
+            while (popCount((magic.mask * magic.magic) >> 56) < 6) {
+                magic.magic = random.sparse();
+            }
+
+            // a magic is good if every occupancy subset maps to a slot that is either
+            // unused in this attempt or already holds the same attack set.
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned index = static_cast<unsigned>(((occupancy[i] & magic.mask) * magic.magic) >> magic.shift);
+
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    magic.attacks[index] = reference[i];
+                } else if (magic.attacks[index] != reference[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void initLines() {
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            detail::BETWEEN[a][b] = 0;
+            detail::LINE[a][b] = 0;
+
+            if (a == b) {
+                continue;
+            }
+
+            if (getBishopAttacks(a, 0) & squareBit(b)) {
+                detail::BETWEEN[a][b] = getBishopAttacks(a, squareBit(b)) & getBishopAttacks(b, squareBit(a));
+                detail::LINE[a][b] = (getBishopAttacks(a, 0) & getBishopAttacks(b, 0)) | squareBit(a) | squareBit(b);
+            } else if (getRookAttacks(a, 0) & squareBit(b)) {
+                detail::BETWEEN[a][b] = getRookAttacks(a, squareBit(b)) & getRookAttacks(b, squareBit(a));
+                detail::LINE[a][b] = (getRookAttacks(a, 0) & getRookAttacks(b, 0)) | squareBit(a) | squareBit(b);
+            }
+        }
+    }
+}
+
+struct AttackTablesInitializer {
+    AttackTablesInitializer() {
+#if !defined(__BMI2__)
+        detail::usePext = cpuSupportsBmi2();
+#endif
+        initSlider(detail::BISHOP_MAGICS, bishopTable, BISHOP_DIRECTIONS);
+        initSlider(detail::ROOK_MAGICS, rookTable, ROOK_DIRECTIONS);
+        initLines();
+    }
+};
+
+const AttackTablesInitializer attackTablesInitializer;
+
+} // namespace
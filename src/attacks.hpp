@@ -0,0 +1,143 @@
+#ifndef ATTACKS_HPP
+#define ATTACKS_HPP
+
+#include <array>
+
+#if defined(__BMI2__)
+#    include <immintrin.h>
+#endif
+
+#include "bitboard.hpp"
+
+namespace detail {
+
+constexpr Bitboard leaperAttacks(int square, const int (&offsets)[8][2]) {
+    Bitboard attacks = 0;
+    int rank = squareRank(square);
+    int file = squareCol(square);
+    for (const auto& offset : offsets) {
+        int r = rank + offset[0];
+        int f = file + offset[1];
+        if (r >= 0 && r < 8 && f >= 0 && f < 8) {
+            attacks |= squareBit(r * 8 + f);
+        }
+    }
+    return attacks;
+}
+
+constexpr int KNIGHT_OFFSETS[8][2] = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+constexpr int KING_OFFSETS[8][2] = {{1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1}, {-1, 0}, {-1, -1}};
+
+constexpr std::array<Bitboard, 64> makeKnightAttacks() {
+    std::array<Bitboard, 64> table{};
+    for (int square = 0; square < 64; ++square) {
+        table[square] = leaperAttacks(square, KNIGHT_OFFSETS);
+    }
+    return table;
+}
+
+constexpr std::array<Bitboard, 64> makeKingAttacks() {
+    std::array<Bitboard, 64> table{};
+    for (int square = 0; square < 64; ++square) {
+        table[square] = leaperAttacks(square, KING_OFFSETS);
+    }
+    return table;
+}
+
+constexpr std::array<std::array<Bitboard, 64>, 2> makePawnAttacks() {
+    std::array<std::array<Bitboard, 64>, 2> table{};
+    for (int square = 0; square < 64; ++square) {
+        Bitboard b = squareBit(square);
+        table[0][square] = shiftNorth(shiftEast(b) | shiftWest(b));
+        table[1][square] = shiftSouth(shiftEast(b) | shiftWest(b));
+    }
+    return table;
+}
+
+inline constexpr std::array<Bitboard, 64> KNIGHT_ATTACKS = makeKnightAttacks();
+inline constexpr std::array<Bitboard, 64> KING_ATTACKS = makeKingAttacks();
+inline constexpr std::array<std::array<Bitboard, 64>, 2> PAWN_ATTACKS = makePawnAttacks();
+
+} // namespace detail
+
+inline Bitboard getKnightAttacks(int square) {
+    return detail::KNIGHT_ATTACKS[square];
+}
+
+inline Bitboard getKingAttacks(int square) {
+    return detail::KING_ATTACKS[square];
+}
+
+// squares attacked by a pawn of the given colour standing on square.
+inline Bitboard getPawnAttacks(PieceColour colour, int square) {
+    return detail::PAWN_ATTACKS[colourIndex(colour)][square];
+}
+
+// fancy magic bitboards: the relevant occupancy (mask) of a slider is hashed with a
+// multiply-shift, or packed with PEXT where BMI2 is available, into a per-square slice
+// of a precomputed attack table.
+struct SliderMagic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+};
+
+namespace detail {
+
+extern SliderMagic BISHOP_MAGICS[64];
+extern SliderMagic ROOK_MAGICS[64];
+
+#if !defined(__BMI2__)
+extern bool usePext;
+unsigned pextIndex(Bitboard occupied, Bitboard mask);
+#endif
+
+inline unsigned sliderIndex(const SliderMagic& magic, Bitboard occupied) {
+#if defined(__BMI2__)
+    return static_cast<unsigned>(_pext_u64(occupied, magic.mask));
+#else
+    if (usePext) {
+        return pextIndex(occupied, magic.mask);
+    }
+    return static_cast<unsigned>(((occupied & magic.mask) * magic.magic) >> magic.shift);
+#endif
+}
+
+} // namespace detail
+
+inline Bitboard getBishopAttacks(int square, Bitboard occupied) {
+    const SliderMagic& magic = detail::BISHOP_MAGICS[square];
+    return magic.attacks[detail::sliderIndex(magic, occupied)];
+}
+
+inline Bitboard getRookAttacks(int square, Bitboard occupied) {
+    const SliderMagic& magic = detail::ROOK_MAGICS[square];
+    return magic.attacks[detail::sliderIndex(magic, occupied)];
+}
+
+// true when slider lookups go through PEXT rather than magic multiplication.
+bool isUsingPext();
+
+inline Bitboard getQueenAttacks(int square, Bitboard occupied) {
+    return getBishopAttacks(square, occupied) | getRookAttacks(square, occupied);
+}
+
+namespace detail {
+
+extern Bitboard BETWEEN[64][64];
+extern Bitboard LINE[64][64];
+
+} // namespace detail
+
+// squares strictly between a and b when they share a rank, file or diagonal, else empty.
+inline Bitboard getBetween(int a, int b) {
+    return detail::BETWEEN[a][b];
+}
+
+// the whole rank, file or diagonal through a and b, else empty.
+inline Bitboard getLine(int a, int b) {
+    return detail::LINE[a][b];
+}
+
+#endif
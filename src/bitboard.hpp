@@ -0,0 +1,130 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#endif
+
+#include "piece.hpp"
+
+// squares are numbered a1 = 0 ... h8 = 63, so bit n of a bitboard is square n.
+// the UI works in (row, col) with row 0 at the top of the screen (rank 8).
+using Bitboard = std::uint64_t;
+
+constexpr int NO_SQUARE = -1;
+
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+constexpr Bitboard FILE_B = FILE_A << 1;
+constexpr Bitboard FILE_G = FILE_A << 6;
+constexpr Bitboard FILE_H = FILE_A << 7;
+
+constexpr Bitboard RANK_1 = 0x00000000000000FFULL;
+constexpr Bitboard RANK_2 = RANK_1 << 8;
+constexpr Bitboard RANK_3 = RANK_1 << 16;
+constexpr Bitboard RANK_4 = RANK_1 << 24;
+constexpr Bitboard RANK_5 = RANK_1 << 32;
+constexpr Bitboard RANK_6 = RANK_1 << 40;
+constexpr Bitboard RANK_7 = RANK_1 << 48;
+constexpr Bitboard RANK_8 = RANK_1 << 56;
+
+constexpr Bitboard squareBit(int square) {
+    return 1ULL << square;
+}
+
+constexpr int toSquare(int row, int col) {
+    return (7 - row) * 8 + col;
+}
+
+constexpr int squareRow(int square) {
+    return 7 - (square >> 3);
+}
+
+constexpr int squareCol(int square) {
+    return square & 7;
+}
+
+constexpr int squareRank(int square) {
+    return square >> 3;
+}
+
+// colour index used for every per-side table: white = 0, black = 1.
+constexpr int colourIndex(PieceColour colour) {
+    return colour == PieceColour::WHITE ? 0 : 1;
+}
+
+constexpr PieceColour colourFromIndex(int index) {
+    return index == 0 ? PieceColour::WHITE : PieceColour::BLACK;
+}
+
+constexpr PieceColour oppositeColour(PieceColour colour) {
+    return colour == PieceColour::WHITE ? PieceColour::BLACK : PieceColour::WHITE;
+}
+
+// pawn = 0 ... king = 5.
+constexpr int pieceIndex(PieceType type) {
+    return static_cast<int>(type) - 1;
+}
+
+constexpr PieceType pieceTypeFromIndex(int index) {
+    return static_cast<PieceType>(index + 1);
+}
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// index of the least significant set bit, b must not be empty.
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+// index of the most significant set bit, b must not be empty.
+inline int msb(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, b);
+    return static_cast<int>(index);
+#else
+    return 63 ^ __builtin_clzll(b);
+#endif
+}
+
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+constexpr bool moreThanOne(Bitboard b) {
+    return (b & (b - 1)) != 0;
+}
+
+constexpr Bitboard shiftNorth(Bitboard b) {
+    return b << 8;
+}
+
+constexpr Bitboard shiftSouth(Bitboard b) {
+    return b >> 8;
+}
+
+constexpr Bitboard shiftEast(Bitboard b) {
+    return (b & ~FILE_H) << 1;
+}
+
+constexpr Bitboard shiftWest(Bitboard b) {
+    return (b & ~FILE_A) >> 1;
+}
+
+#endif
@@ -0,0 +1,569 @@
+#include "board.hpp"
+#include "attacks.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+// castling rights that survive a move touching the square.
+constexpr std::uint8_t castlingMask(int square) {
+    switch (square) {
+    case 0:
+        return ALL_CASTLING & ~WHITE_QUEEN_SIDE;
+    case 4:
+        return ALL_CASTLING & ~(WHITE_KING_SIDE | WHITE_QUEEN_SIDE);
+    case 7:
+        return ALL_CASTLING & ~WHITE_KING_SIDE;
+    case 56:
+        return ALL_CASTLING & ~BLACK_QUEEN_SIDE;
+    case 60:
+        return ALL_CASTLING & ~(BLACK_KING_SIDE | BLACK_QUEEN_SIDE);
+    case 63:
+        return ALL_CASTLING & ~BLACK_KING_SIDE;
+    default:
+        return ALL_CASTLING;
+    }
+}
+
+constexpr std::size_t REPETITION_FILTER_SIZE = 4096;
+constexpr std::size_t KEY_HISTORY_RESERVE = 1024;
+
+constexpr std::uint8_t makeCode(int colour, PieceType type) {
+    return static_cast<std::uint8_t>((colour << 3) | static_cast<int>(type));
+}
+
+const char PIECE_CHARS[] = " pnbrqk";
+
+PieceType pieceTypeFromChar(char c) {
+    switch (std::tolower(static_cast<unsigned char>(c))) {
+    case 'p':
+        return PieceType::PAWN;
+    case 'n':
+        return PieceType::KNIGHT;
+    case 'b':
+        return PieceType::BISHOP;
+    case 'r':
+        return PieceType::ROOK;
+    case 'q':
+        return PieceType::QUEEN;
+    case 'k':
+        return PieceType::KING;
+    default:
+        return PieceType::EMPTY;
+    }
+}
+
+char pieceChar(PieceType type) {
+    switch (type) {
+    case PieceType::PAWN:
+        return PIECE_CHARS[1];
+    case PieceType::KNIGHT:
+        return PIECE_CHARS[2];
+    case PieceType::BISHOP:
+        return PIECE_CHARS[3];
+    case PieceType::ROOK:
+        return PIECE_CHARS[4];
+    case PieceType::QUEEN:
+        return PIECE_CHARS[5];
+    case PieceType::KING:
+        return PIECE_CHARS[6];
+    default:
+        return PIECE_CHARS[0];
+    }
+}
+
+} // namespace
+
+Board::Board()
+    : m_repetitionFilter(REPETITION_FILTER_SIZE, 0) {
+    m_keyHistory.reserve(KEY_HISTORY_RESERVE);
+    clear();
+}
+
+void Board::clear() {
+    for (auto& colourBitboards : m_pieceBitboards) {
+        for (Bitboard& bitboard : colourBitboards) {
+            bitboard = 0;
+        }
+    }
+    m_colourBitboards[0] = m_colourBitboards[1] = 0;
+    m_occupied = 0;
+    m_checkers = 0;
+
+    for (std::uint8_t& square : m_mailbox) {
+        square = 0;
+    }
+
+    m_sideToMove = PieceColour::WHITE;
+    m_castlingRights = 0;
+    m_enPassantSquare = NO_SQUARE;
+    m_halfmoveClock = 0;
+    m_fullmoveNumber = 1;
+    m_key = 0;
+    m_pawnKey = 0;
+    m_psqt = Score();
+    m_phase = 0;
+
+    resetHistory();
+}
+
+void Board::setupStartPosition() {
+    clear();
+
+    const PieceType backRank[8] = {PieceType::ROOK,  PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN,
+                                   PieceType::KING,  PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK};
+
+    for (int col = 0; col < 8; ++col) {
+        addPieceCode(makeCode(1, backRank[col]), toSquare(0, col));
+        addPieceCode(makeCode(1, PieceType::PAWN), toSquare(1, col));
+        addPieceCode(makeCode(0, PieceType::PAWN), toSquare(6, col));
+        addPieceCode(makeCode(0, backRank[col]), toSquare(7, col));
+    }
+
+    m_castlingRights = ALL_CASTLING;
+    m_key = computeKey();
+    updateCheckers();
+    resetHistory();
+}
+
+bool Board::setFromFen(const std::string& fen) {
+    clear();
+
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    int halfmove = 0;
+    int fullmove = 1;
+
+    if (!(stream >> placement >> side)) {
+        return false;
+    }
+    stream >> castling >> enPassant >> halfmove >> fullmove;
+
+    int row = 0;
+    int col = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            ++row;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+        } else {
+            PieceType type = pieceTypeFromChar(c);
+            if (type == PieceType::EMPTY || row > 7 || col > 7) {
+                clear();
+                return false;
+            }
+            PieceColour colour = std::isupper(static_cast<unsigned char>(c)) ? PieceColour::WHITE : PieceColour::BLACK;
+            addPieceCode(makeCode(colourIndex(colour), type), toSquare(row, col));
+            ++col;
+        }
+    }
+
+    if (popCount(getPieces(PieceColour::WHITE, PieceType::KING)) != 1 ||
+        popCount(getPieces(PieceColour::BLACK, PieceType::KING)) != 1) {
+        clear();
+        return false;
+    }
+
+    m_sideToMove = side == "b" ? PieceColour::BLACK : PieceColour::WHITE;
+
+    for (char c : castling) {
+        switch (c) {
+        case 'K':
+            m_castlingRights |= WHITE_KING_SIDE;
+            break;
+        case 'Q':
+            m_castlingRights |= WHITE_QUEEN_SIDE;
+            break;
+        case 'k':
+            m_castlingRights |= BLACK_KING_SIDE;
+            break;
+        case 'q':
+            m_castlingRights |= BLACK_QUEEN_SIDE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // a right is only kept while its king and rook stand on their home squares; the move
+    // generator castles from those squares.
+    const struct {
+        int square;
+        std::uint8_t code;
+    } castlingHomes[] = {{0, makeCode(0, PieceType::ROOK)},  {4, makeCode(0, PieceType::KING)},  {7, makeCode(0, PieceType::ROOK)},
+                         {56, makeCode(1, PieceType::ROOK)}, {60, makeCode(1, PieceType::KING)}, {63, makeCode(1, PieceType::ROOK)}};
+    for (const auto& home : castlingHomes) {
+        if (getPieceCode(home.square) != home.code) {
+            m_castlingRights &= castlingMask(home.square);
+        }
+    }
+
+    if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8') {
+        m_enPassantSquare = static_cast<std::int8_t>((enPassant[1] - '1') * 8 + (enPassant[0] - 'a'));
+    }
+
+    // only keep an en-passant square that can actually be captured on, so transpositions
+    // that differ only in a dead en-passant square hash the same.
+    if (m_enPassantSquare != NO_SQUARE &&
+        !(getPawnAttacks(oppositeColour(m_sideToMove), m_enPassantSquare) & getPieces(m_sideToMove, PieceType::PAWN))) {
+        m_enPassantSquare = NO_SQUARE;
+    }
+
+    m_halfmoveClock = static_cast<std::uint8_t>(halfmove);
+    m_fullmoveNumber = fullmove;
+
+    m_key = computeKey();
+    updateCheckers();
+    resetHistory();
+    return true;
+}
+
+std::string Board::getFen() const {
+    std::string fen;
+
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            Piece piece = getPiece(toSquare(row, col));
+            if (!piece.active) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                fen += static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            char c = pieceChar(piece.type);
+            fen += piece.colour == PieceColour::WHITE ? static_cast<char>(std::toupper(c)) : c;
+        }
+        if (empty) {
+            fen += static_cast<char>('0' + empty);
+        }
+        if (row < 7) {
+            fen += '/';
+        }
+    }
+
+    fen += m_sideToMove == PieceColour::WHITE ? " w " : " b ";
+
+    if (!m_castlingRights) {
+        fen += '-';
+    }
+    if (m_castlingRights & WHITE_KING_SIDE) {
+        fen += 'K';
+    }
+    if (m_castlingRights & WHITE_QUEEN_SIDE) {
+        fen += 'Q';
+    }
+    if (m_castlingRights & BLACK_KING_SIDE) {
+        fen += 'k';
+    }
+    if (m_castlingRights & BLACK_QUEEN_SIDE) {
+        fen += 'q';
+    }
+
+    fen += ' ';
+    if (m_enPassantSquare == NO_SQUARE) {
+        fen += '-';
+    } else {
+        fen += static_cast<char>('a' + squareCol(m_enPassantSquare));
+        fen += static_cast<char>('1' + squareRank(m_enPassantSquare));
+    }
+
+    fen += ' ' + std::to_string(m_halfmoveClock) + ' ' + std::to_string(m_fullmoveNumber);
+    return fen;
+}
+
+void Board::addPieceCode(std::uint8_t code, int square) {
+    int colour = code >> 3;
+    Bitboard bit = squareBit(square);
+
+    m_key ^= ZOBRIST.pieces[colour][(code & 7) - 1][square];
+    if ((code & 7) == static_cast<int>(PieceType::PAWN)) {
+        m_pawnKey ^= ZOBRIST.pieces[colour][0][square];
+    }
+    m_psqt += getPieceSquareScore(colour, (code & 7) - 1, square);
+    m_phase += PHASE_WEIGHTS[(code & 7) - 1];
+    m_pieceBitboards[colour][(code & 7) - 1] |= bit;
+    m_colourBitboards[colour] |= bit;
+    m_occupied |= bit;
+    m_mailbox[square] = code;
+}
+
+void Board::removePieceCode(std::uint8_t code, int square) {
+    int colour = code >> 3;
+    Bitboard bit = squareBit(square);
+
+    m_key ^= ZOBRIST.pieces[colour][(code & 7) - 1][square];
+    if ((code & 7) == static_cast<int>(PieceType::PAWN)) {
+        m_pawnKey ^= ZOBRIST.pieces[colour][0][square];
+    }
+    m_psqt -= getPieceSquareScore(colour, (code & 7) - 1, square);
+    m_phase -= PHASE_WEIGHTS[(code & 7) - 1];
+    m_pieceBitboards[colour][(code & 7) - 1] &= ~bit;
+    m_colourBitboards[colour] &= ~bit;
+    m_occupied &= ~bit;
+    m_mailbox[square] = 0;
+}
+
+void Board::putPiece(const Piece& piece, int square) {
+    if (m_mailbox[square] != 0) {
+        removePieceCode(m_mailbox[square], square);
+    }
+    addPieceCode(makeCode(colourIndex(piece.colour), piece.type), square);
+    updateCheckers();
+    resetHistory();
+}
+
+void Board::removePiece(int square) {
+    if (m_mailbox[square] != 0) {
+        removePieceCode(m_mailbox[square], square);
+        updateCheckers();
+        resetHistory();
+    }
+}
+
+void Board::resetHistory() {
+    std::fill(m_repetitionFilter.begin(), m_repetitionFilter.end(), 0);
+    m_keyHistory.clear();
+    m_keyHistory.push_back(m_key);
+    ++m_repetitionFilter[m_key & (REPETITION_FILTER_SIZE - 1)];
+}
+
+std::uint64_t Board::computeKey() const {
+    std::uint64_t key = 0;
+
+    Bitboard occupied = m_occupied;
+    while (occupied) {
+        int square = popLsb(occupied);
+        key ^= ZOBRIST.pieces[m_mailbox[square] >> 3][(m_mailbox[square] & 7) - 1][square];
+    }
+
+    key ^= ZOBRIST.castling[m_castlingRights];
+    if (m_enPassantSquare != NO_SQUARE) {
+        key ^= ZOBRIST.enPassantFile[squareCol(m_enPassantSquare)];
+    }
+    if (m_sideToMove == PieceColour::BLACK) {
+        key ^= ZOBRIST.sideToMove;
+    }
+
+    return key;
+}
+
+bool Board::isRepetition(int count) const {
+    // the filter counts the current position too, so one hit means it is new.
+    if (m_repetitionFilter[m_key & (REPETITION_FILTER_SIZE - 1)] <= 1) {
+        return false;
+    }
+
+    const int last = static_cast<int>(m_keyHistory.size()) - 1;
+    const int window = std::min<int>(m_halfmoveClock, last);
+    int occurrences = 0;
+
+    for (int distance = 4; distance <= window; distance += 2) {
+        if (m_keyHistory[last - distance] == m_key && ++occurrences >= count) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Board::updateCheckers() {
+    int king = findKing(m_sideToMove);
+    m_checkers = king == NO_SQUARE ? 0 : getAttackersTo(king, m_occupied) & getOccupancy(oppositeColour(m_sideToMove));
+}
+
+void Board::makeMove(Move move, UndoInfo& undo) {
+    const int from = move.getFrom();
+    const int to = move.getTo();
+    const int flags = move.getFlags();
+    const int us = colourIndex(m_sideToMove);
+    const std::uint8_t moving = m_mailbox[from];
+
+    undo.key = m_key;
+    undo.checkers = m_checkers;
+    undo.capturedPiece = 0;
+    undo.castlingRights = m_castlingRights;
+    undo.enPassantSquare = m_enPassantSquare;
+    undo.halfmoveClock = m_halfmoveClock;
+
+    ++m_halfmoveClock;
+    if (m_enPassantSquare != NO_SQUARE) {
+        m_key ^= ZOBRIST.enPassantFile[squareCol(m_enPassantSquare)];
+        m_enPassantSquare = NO_SQUARE;
+    }
+
+    if (flags == EN_PASSANT) {
+        int victim = to + (us == 0 ? -8 : 8);
+        undo.capturedPiece = m_mailbox[victim];
+        removePieceCode(undo.capturedPiece, victim);
+    } else if (move.isCapture()) {
+        undo.capturedPiece = m_mailbox[to];
+        removePieceCode(undo.capturedPiece, to);
+    }
+
+    if (undo.capturedPiece != 0 || (moving & 7) == static_cast<int>(PieceType::PAWN)) {
+        m_halfmoveClock = 0;
+    }
+
+    removePieceCode(moving, from);
+    addPieceCode(move.isPromotion() ? makeCode(us, move.getPromotionType()) : moving, to);
+
+    if (flags == DOUBLE_PAWN_PUSH) {
+        int passed = (from + to) / 2;
+        if (getPawnAttacks(m_sideToMove, passed) & m_pieceBitboards[us ^ 1][pieceIndex(PieceType::PAWN)]) {
+            m_enPassantSquare = static_cast<std::int8_t>(passed);
+            m_key ^= ZOBRIST.enPassantFile[squareCol(passed)];
+        }
+    } else if (flags == KING_CASTLE) {
+        std::uint8_t rook = m_mailbox[to + 1];
+        removePieceCode(rook, to + 1);
+        addPieceCode(rook, to - 1);
+    } else if (flags == QUEEN_CASTLE) {
+        std::uint8_t rook = m_mailbox[to - 2];
+        removePieceCode(rook, to - 2);
+        addPieceCode(rook, to + 1);
+    }
+
+    m_key ^= ZOBRIST.castling[m_castlingRights];
+    m_castlingRights &= castlingMask(from) & castlingMask(to);
+    m_key ^= ZOBRIST.castling[m_castlingRights];
+
+    if (us == 1) {
+        ++m_fullmoveNumber;
+    }
+    m_sideToMove = oppositeColour(m_sideToMove);
+    m_key ^= ZOBRIST.sideToMove;
+
+    updateCheckers();
+
+    m_keyHistory.push_back(m_key);
+    ++m_repetitionFilter[m_key & (REPETITION_FILTER_SIZE - 1)];
+}
+
+void Board::unmakeMove(Move move, const UndoInfo& undo) {
+    const int from = move.getFrom();
+    const int to = move.getTo();
+    const int flags = move.getFlags();
+
+    --m_repetitionFilter[m_key & (REPETITION_FILTER_SIZE - 1)];
+    m_keyHistory.pop_back();
+
+    m_sideToMove = oppositeColour(m_sideToMove);
+    const int us = colourIndex(m_sideToMove);
+    if (us == 1) {
+        --m_fullmoveNumber;
+    }
+
+    if (flags == KING_CASTLE) {
+        std::uint8_t rook = m_mailbox[to - 1];
+        removePieceCode(rook, to - 1);
+        addPieceCode(rook, to + 1);
+    } else if (flags == QUEEN_CASTLE) {
+        std::uint8_t rook = m_mailbox[to + 1];
+        removePieceCode(rook, to + 1);
+        addPieceCode(rook, to - 2);
+    }
+
+    std::uint8_t moved = m_mailbox[to];
+    removePieceCode(moved, to);
+    addPieceCode(move.isPromotion() ? makeCode(us, PieceType::PAWN) : moved, from);
+
+    if (flags == EN_PASSANT) {
+        addPieceCode(undo.capturedPiece, to + (us == 0 ? -8 : 8));
+    } else if (undo.capturedPiece != 0) {
+        addPieceCode(undo.capturedPiece, to);
+    }
+
+    m_checkers = undo.checkers;
+    m_castlingRights = undo.castlingRights;
+    m_enPassantSquare = undo.enPassantSquare;
+    m_halfmoveClock = undo.halfmoveClock;
+    m_key = undo.key;
+}
+
+void Board::makeNullMove(UndoInfo& undo) {
+    undo.key = m_key;
+    undo.checkers = m_checkers;
+    undo.capturedPiece = 0;
+    undo.castlingRights = m_castlingRights;
+    undo.enPassantSquare = m_enPassantSquare;
+    undo.halfmoveClock = m_halfmoveClock;
+
+    if (m_enPassantSquare != NO_SQUARE) {
+        m_key ^= ZOBRIST.enPassantFile[squareCol(m_enPassantSquare)];
+        m_enPassantSquare = NO_SQUARE;
+    }
+
+    m_halfmoveClock = 0;
+    m_sideToMove = oppositeColour(m_sideToMove);
+    m_key ^= ZOBRIST.sideToMove;
+    m_checkers = 0;
+
+    m_keyHistory.push_back(m_key);
+    ++m_repetitionFilter[m_key & (REPETITION_FILTER_SIZE - 1)];
+}
+
+void Board::unmakeNullMove(const UndoInfo& undo) {
+    --m_repetitionFilter[m_key & (REPETITION_FILTER_SIZE - 1)];
+    m_keyHistory.pop_back();
+
+    m_sideToMove = oppositeColour(m_sideToMove);
+    m_checkers = undo.checkers;
+    m_enPassantSquare = undo.enPassantSquare;
+    m_halfmoveClock = undo.halfmoveClock;
+    m_key = undo.key;
+}
+
+Piece Board::getPiece(int square) const {
+    return decodePiece(m_mailbox[square]);
+}
+
+int Board::findKing(PieceColour colour) const {
+    Bitboard king = getPieces(colour, PieceType::KING);
+    return king ? lsb(king) : NO_SQUARE;
+}
+
+Bitboard Board::getAttackersTo(int square, Bitboard occupied) const {
+    Bitboard queens = getPieces(PieceType::QUEEN);
+
+    return (getPawnAttacks(PieceColour::WHITE, square) & getPieces(PieceColour::BLACK, PieceType::PAWN)) |
+           (getPawnAttacks(PieceColour::BLACK, square) & getPieces(PieceColour::WHITE, PieceType::PAWN)) |
+           (getKnightAttacks(square) & getPieces(PieceType::KNIGHT)) | (getKingAttacks(square) & getPieces(PieceType::KING)) |
+           (getBishopAttacks(square, occupied) & (getPieces(PieceType::BISHOP) | queens)) |
+           (getRookAttacks(square, occupied) & (getPieces(PieceType::ROOK) | queens));
+}
+
+bool Board::isSquareAttacked(int square, PieceColour attacker) const {
+    // look outwards from the target square with each piece's attack pattern and
+    // intersect with the attacker's pieces of that type.
+    if (getPawnAttacks(oppositeColour(attacker), square) & getPieces(attacker, PieceType::PAWN)) {
+        return true;
+    }
+    if (getKnightAttacks(square) & getPieces(attacker, PieceType::KNIGHT)) {
+        return true;
+    }
+    if (getKingAttacks(square) & getPieces(attacker, PieceType::KING)) {
+        return true;
+    }
+
+    Bitboard queens = getPieces(attacker, PieceType::QUEEN);
+    if (getBishopAttacks(square, m_occupied) & (getPieces(attacker, PieceType::BISHOP) | queens)) {
+        return true;
+    }
+    return (getRookAttacks(square, m_occupied) & (getPieces(attacker, PieceType::ROOK) | queens)) != 0;
+}
+
+bool Board::isInCheck(PieceColour colour) const {
+    if (colour == m_sideToMove) {
+        return m_checkers != 0;
+    }
+
+    int king = findKing(colour);
+    return king != NO_SQUARE && isSquareAttacked(king, oppositeColour(colour));
+}
@@ -0,0 +1,192 @@
+#ifndef BOARD_HPP
+#define BOARD_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "move.hpp"
+#include "piece.hpp"
+#include "psqt.hpp"
+
+enum CastlingRight : std::uint8_t {
+    WHITE_KING_SIDE = 1,
+    WHITE_QUEEN_SIDE = 2,
+    BLACK_KING_SIDE = 4,
+    BLACK_QUEEN_SIDE = 8,
+    ALL_CASTLING = 15,
+};
+
+// everything makeMove destroys and unmakeMove cannot recompute from the move itself.
+struct UndoInfo {
+    std::uint64_t key;
+    Bitboard checkers;
+    std::uint8_t capturedPiece;
+    std::uint8_t castlingRights;
+    std::int8_t enPassantSquare;
+    std::uint8_t halfmoveClock;
+};
+
+// bitboard position: one bitboard per (colour, piece type), per-colour occupancy and a
+// square-indexed mailbox so "what is on this square" stays a single load.
+class Board {
+public:
+    Board();
+
+    void clear();
+    void setupStartPosition();
+
+    // returns false and leaves the board cleared if the FEN cannot be parsed.
+    bool setFromFen(const std::string& fen);
+    std::string getFen() const;
+
+    void putPiece(const Piece& piece, int square);
+    void removePiece(int square);
+
+    // applies a pseudo-legal move and records what unmakeMove needs in undo. neither
+    // function checks legality or allocates.
+    void makeMove(Move move, UndoInfo& undo);
+    void unmakeMove(Move move, const UndoInfo& undo);
+
+    // passes the turn, for null-move pruning. only valid when the side to move is not in
+    // check. the halfmove clock restarts so repetitions are never matched across the null.
+    void makeNullMove(UndoInfo& undo);
+    void unmakeNullMove(const UndoInfo& undo);
+
+public:
+    Piece getPiece(int square) const;
+
+    // (colourIndex << 3) | PieceType, 0 for an empty square.
+    std::uint8_t getPieceCode(int square) const {
+        return m_mailbox[square];
+    }
+
+    PieceType getPieceType(int square) const {
+        return static_cast<PieceType>(m_mailbox[square] & 7);
+    }
+
+    bool isSquareEmpty(int square) const {
+        return (m_occupied & squareBit(square)) == 0;
+    }
+
+    bool isOpponentPiece(int square, PieceColour colour) const {
+        return (m_colourBitboards[colourIndex(oppositeColour(colour))] & squareBit(square)) != 0;
+    }
+
+    Bitboard getPieces(PieceColour colour, PieceType type) const {
+        return m_pieceBitboards[colourIndex(colour)][pieceIndex(type)];
+    }
+
+    Bitboard getPieces(PieceType type) const {
+        return m_pieceBitboards[0][pieceIndex(type)] | m_pieceBitboards[1][pieceIndex(type)];
+    }
+
+    Bitboard getOccupancy(PieceColour colour) const {
+        return m_colourBitboards[colourIndex(colour)];
+    }
+
+    Bitboard getOccupancy() const {
+        return m_occupied;
+    }
+
+    PieceColour getSideToMove() const {
+        return m_sideToMove;
+    }
+
+    std::uint8_t getCastlingRights() const {
+        return m_castlingRights;
+    }
+
+    int getEnPassantSquare() const {
+        return m_enPassantSquare;
+    }
+
+    int getHalfmoveClock() const {
+        return m_halfmoveClock;
+    }
+
+    int getFullmoveNumber() const {
+        return m_fullmoveNumber;
+    }
+
+    // zobrist key of the position, updated incrementally by makeMove/unmakeMove.
+    std::uint64_t getKey() const {
+        return m_key;
+    }
+
+    std::uint64_t computeKey() const;
+
+    // zobrist key of the pawns alone, for the pawn structure cache.
+    std::uint64_t getPawnKey() const {
+        return m_pawnKey;
+    }
+
+    // material + piece-square sum, white minus black, kept up to date by every piece
+    // add/remove so the evaluation never has to loop over the pieces for it.
+    Score getPsqtScore() const {
+        return m_psqt;
+    }
+
+    // 0 (bare kings and pawns) ... MAX_PHASE (full set), may exceed it after promotions.
+    int getPhase() const {
+        return m_phase;
+    }
+
+    // true when the current position already occurred at least `count` times since the
+    // last capture or pawn move: 1 for search draws, 2 for threefold repetition.
+    bool isRepetition(int count = 1) const;
+
+    bool isFiftyMoveRule() const {
+        return m_halfmoveClock >= 100;
+    }
+
+    static Piece decodePiece(std::uint8_t code) {
+        return code == 0 ? Piece() : Piece(static_cast<PieceType>(code & 7), colourFromIndex(code >> 3));
+    }
+
+    int findKing(PieceColour colour) const;
+
+    // enemy pieces giving check to the side to move, kept up to date by makeMove.
+    Bitboard getCheckers() const {
+        return m_checkers;
+    }
+
+    // pieces of both colours attacking square, given an occupancy that may differ from
+    // the board's own (e.g. with the king lifted off for x-ray checks).
+    Bitboard getAttackersTo(int square, Bitboard occupied) const;
+    bool isSquareAttacked(int square, PieceColour attacker) const;
+    bool isInCheck(PieceColour colour) const;
+
+private:
+    void addPieceCode(std::uint8_t code, int square);
+    void removePieceCode(std::uint8_t code, int square);
+    void updateCheckers();
+    void resetHistory();
+
+private:
+    Bitboard m_pieceBitboards[2][6];
+    Bitboard m_colourBitboards[2];
+    Bitboard m_occupied;
+    Bitboard m_checkers;
+
+    // (colourIndex << 3) | PieceType, 0 for an empty square.
+    std::uint8_t m_mailbox[64];
+
+    PieceColour m_sideToMove;
+    std::uint8_t m_castlingRights;
+    std::int8_t m_enPassantSquare;
+    std::uint8_t m_halfmoveClock;
+    int m_fullmoveNumber;
+    std::uint64_t m_key;
+    std::uint64_t m_pawnKey;
+    Score m_psqt;
+    int m_phase;
+
+    // keys of every position since setup, plus a per-bucket occurrence count so the common
+    // "never seen before" answer needs no scan.
+    std::vector<std::uint64_t> m_keyHistory;
+    std::vector<std::uint8_t> m_repetitionFilter;
+};
+
+#endif
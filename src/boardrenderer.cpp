@@ -0,0 +1,251 @@
+#include "boardrenderer.hpp"
+
+#include <algorithm>
+#include <future>
+#include <iostream>
+
+#include <SDL_image.h>
+
+#include "assets.hpp"
+#include "bitboard.hpp"
+
+namespace {
+
+// file name parts in colourIndex and pieceIndex order.
+const char* const COLOUR_NAMES[2] = {"white", "black"};
+const char* const PIECE_NAMES[6] = {"pawn", "rook", "knight", "bishop", "queen", "king"};
+
+// transparent border around each atlas cell, so filtering at a cell's edge never picks up
+// its neighbour.
+constexpr int CELL_PADDING = 1;
+
+constexpr SDL_Color OPAQUE_WHITE = {255, 255, 255, 255};
+
+} // namespace
+
+BoardRenderer::BoardRenderer(SDL_Renderer* renderer, int boardSize, int tileSize, const BoardTheme& theme)
+    : m_renderer(renderer)
+    , m_boardSize(boardSize)
+    , m_tileSize(tileSize)
+    , m_theme(theme)
+    , m_atlas(nullptr)
+    , m_pieceRegions{}
+    , m_whiteRegion{}
+    , m_boardLayer(nullptr)
+    , m_boardLayerValid(false)
+    , m_drawCalls(0)
+    , m_frameDrawCalls(0) {}
+
+BoardRenderer::~BoardRenderer() {
+    if (m_atlas) {
+        SDL_DestroyTexture(m_atlas);
+    }
+    if (m_boardLayer) {
+        SDL_DestroyTexture(m_boardLayer);
+    }
+}
+
+AtlasImage BoardRenderer::decodePieces(const std::string& directory) {
+    std::future<SDL_Surface*> decoding[2][6];
+
+    for (int colour = 0; colour < 2; ++colour) {
+        for (int piece = 0; piece < 6; ++piece) {
+            std::string path = directory + "/" + COLOUR_NAMES[colour] + "-" + PIECE_NAMES[piece] + ".png";
+            decoding[colour][piece] = std::async(std::launch::async, [path]() -> SDL_Surface* {
+                Asset asset = Asset::load(path);
+                if (!asset.isLoaded()) {
+                    return nullptr;
+                }
+
+                // errors are per thread, so report them from here.
+                SDL_Surface* image = IMG_Load_RW(SDL_RWFromConstMem(asset.getData(), static_cast<int>(asset.getSize())), 1);
+                if (!image) {
+                    std::cerr << "Failed to load texture " << path << "! SDL_image Error: " << IMG_GetError() << std::endl;
+                }
+                return image;
+            });
+        }
+    }
+
+    SDL_Surface* images[2][6] = {};
+    int cellSize = 0;
+    bool loaded = true;
+
+    for (int colour = 0; colour < 2; ++colour) {
+        for (int piece = 0; piece < 6; ++piece) {
+            images[colour][piece] = decoding[colour][piece].get();
+
+            if (!images[colour][piece]) {
+                loaded = false;
+                continue;
+            }
+            cellSize = std::max({cellSize, images[colour][piece]->w, images[colour][piece]->h});
+        }
+    }
+
+    // six pieces per row, a row per colour, and a white cell after the first row.
+    AtlasImage atlas;
+    const int stride = cellSize + 2 * CELL_PADDING;
+    atlas.surface = loaded ? SDL_CreateRGBSurfaceWithFormat(0, stride * 7, stride * 2, 32, SDL_PIXELFORMAT_RGBA32) : nullptr;
+
+    if (atlas.surface) {
+        SDL_FillRect(atlas.surface, nullptr, SDL_MapRGBA(atlas.surface->format, 0, 0, 0, 0));
+
+        const float width = static_cast<float>(atlas.surface->w);
+        const float height = static_cast<float>(atlas.surface->h);
+
+        for (int colour = 0; colour < 2; ++colour) {
+            for (int piece = 0; piece < 6; ++piece) {
+                SDL_Rect cell = {piece * stride + CELL_PADDING, colour * stride + CELL_PADDING, cellSize, cellSize};
+                SDL_SetSurfaceBlendMode(images[colour][piece], SDL_BLENDMODE_NONE);
+                SDL_BlitScaled(images[colour][piece], nullptr, atlas.surface, &cell);
+
+                atlas.pieceRegions[colour][piece] = {cell.x / width, cell.y / height, (cell.x + cell.w) / width,
+                                                     (cell.y + cell.h) / height};
+            }
+        }
+
+        // every highlight samples the middle of the white cell, tinted by its vertex colour.
+        SDL_Rect white = {6 * stride, 0, stride, stride};
+        SDL_FillRect(atlas.surface, &white, SDL_MapRGBA(atlas.surface->format, 255, 255, 255, 255));
+        float u = (white.x + stride * 0.5f) / width;
+        float v = (white.y + stride * 0.5f) / height;
+        atlas.whiteRegion = {u, v, u, v};
+    }
+
+    for (auto& colour : images) {
+        for (SDL_Surface* image : colour) {
+            if (image) {
+                SDL_FreeSurface(image);
+            }
+        }
+    }
+
+    return atlas;
+}
+
+bool BoardRenderer::loadPieces(AtlasImage& image) {
+    if (!image.surface) {
+        return false;
+    }
+
+    if (m_atlas) {
+        SDL_DestroyTexture(m_atlas);
+    }
+    m_atlas = SDL_CreateTextureFromSurface(m_renderer, image.surface);
+    if (m_atlas) {
+        SDL_SetTextureBlendMode(m_atlas, SDL_BLENDMODE_BLEND);
+        std::copy(&image.pieceRegions[0][0], &image.pieceRegions[0][0] + 12, &m_pieceRegions[0][0]);
+        m_whiteRegion = image.whiteRegion;
+    } else {
+        std::cerr << "Failed to create the piece atlas. SDL_Error: " << SDL_GetError() << std::endl;
+    }
+
+    SDL_FreeSurface(image.surface);
+    image.surface = nullptr;
+
+    return m_atlas != nullptr;
+}
+
+AtlasRegion BoardRenderer::getPieceRegion(PieceColour colour, PieceType type) const {
+    return m_pieceRegions[colourIndex(colour)][pieceIndex(type)];
+}
+
+void BoardRenderer::beginFrame() {
+    m_vertices.clear();
+    m_frameDrawCalls = 0;
+}
+
+void BoardRenderer::drawBoard(const SDL_FRect& area) {
+    if (!m_boardLayerValid) {
+        renderBoardLayer();
+    }
+
+    if (m_boardLayer) {
+        SDL_RenderCopyF(m_renderer, m_boardLayer, nullptr, &area);
+        ++m_frameDrawCalls;
+        return;
+    }
+
+    // no render target support: the tiles go into the batch like any other square.
+    for (int square = 0; square < m_boardSize * m_boardSize; ++square) {
+        bool light = squareRow(square) % 2 == squareCol(square) % 2;
+        addSquare(area, square, light ? m_theme.lightTile : m_theme.darkTile);
+    }
+}
+
+void BoardRenderer::addSquare(const SDL_FRect& area, int square, SDL_Color colour) {
+    const float tile = area.w / m_boardSize;
+    SDL_FRect rect = {area.x + squareCol(square) * tile, area.y + squareRow(square) * tile, tile, tile};
+    addQuad(rect, m_whiteRegion, colour);
+}
+
+void BoardRenderer::addPiece(const SDL_FRect& area, int square, std::uint8_t pieceCode) {
+    if (pieceCode == 0) {
+        return;
+    }
+
+    const float tile = area.w / m_boardSize;
+    SDL_FRect rect = {area.x + squareCol(square) * tile, area.y + squareRow(square) * tile, tile, tile};
+    addQuad(rect, m_pieceRegions[pieceCode >> 3][(pieceCode & 7) - 1], OPAQUE_WHITE);
+}
+
+void BoardRenderer::endFrame() {
+    const int quadCount = static_cast<int>(m_vertices.size() / 4);
+
+    // two triangles per quad; the pattern never changes, so it is only extended.
+    for (int quad = static_cast<int>(m_indices.size() / 6); quad < quadCount; ++quad) {
+        int first = quad * 4;
+        m_indices.insert(m_indices.end(), {first, first + 1, first + 2, first + 2, first + 1, first + 3});
+    }
+
+    if (quadCount > 0 && m_atlas) {
+        SDL_RenderGeometry(m_renderer, m_atlas, m_vertices.data(), static_cast<int>(m_vertices.size()), m_indices.data(),
+                           quadCount * 6);
+        ++m_frameDrawCalls;
+    }
+
+    m_drawCalls = m_frameDrawCalls;
+}
+
+void BoardRenderer::renderBoardLayer() {
+    m_boardLayerValid = true;
+
+    if (!SDL_RenderTargetSupported(m_renderer)) {
+        return;
+    }
+
+    if (!m_boardLayer) {
+        const int size = m_boardSize * m_tileSize;
+        m_boardLayer = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
+        if (!m_boardLayer) {
+            std::cerr << "Failed to create the board layer. SDL_Error: " << SDL_GetError() << std::endl;
+            return;
+        }
+    }
+
+    // the layer can be built while drawing into another target, e.g. the multi-board grid.
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(m_renderer);
+    SDL_SetRenderTarget(m_renderer, m_boardLayer);
+
+    for (int row = 0; row < m_boardSize; ++row) {
+        for (int col = 0; col < m_boardSize; ++col) {
+            const SDL_Color& colour = row % 2 == col % 2 ? m_theme.lightTile : m_theme.darkTile;
+            SDL_SetRenderDrawColor(m_renderer, colour.r, colour.g, colour.b, colour.a);
+            SDL_Rect tile = {col * m_tileSize, row * m_tileSize, m_tileSize, m_tileSize};
+            SDL_RenderFillRect(m_renderer, &tile);
+        }
+    }
+
+    SDL_SetRenderTarget(m_renderer, previousTarget);
+}
+
+void BoardRenderer::addQuad(const SDL_FRect& rect, const AtlasRegion& region, SDL_Color colour) {
+    const float right = rect.x + rect.w;
+    const float bottom = rect.y + rect.h;
+
+    m_vertices.push_back({{rect.x, rect.y}, colour, {region.u0, region.v0}});
+    m_vertices.push_back({{right, rect.y}, colour, {region.u1, region.v0}});
+    m_vertices.push_back({{rect.x, bottom}, colour, {region.u0, region.v1}});
+    m_vertices.push_back({{right, bottom}, colour, {region.u1, region.v1}});
+}
@@ -0,0 +1,105 @@
+#ifndef BOARDRENDERER_HPP
+#define BOARDRENDERER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+
+#include "piece.hpp"
+
+struct BoardTheme {
+    SDL_Color lightTile;
+    SDL_Color darkTile;
+};
+
+// a piece's cell in the atlas in normalised texture coordinates, e.g. for ImGui::Image.
+struct AtlasRegion {
+    float u0, v0, u1, v1;
+};
+
+// the piece atlas as pixels, before it is uploaded.
+struct AtlasImage {
+    SDL_Surface* surface = nullptr;
+    AtlasRegion pieceRegions[2][6] = {};
+    AtlasRegion whiteRegion = {};
+};
+
+// draws boards with a handful of draw calls. the checkerboard is rendered once into a target
+// texture and copied, the twelve piece images are packed into one atlas, and every piece and
+// highlight of the frame is collected as a quad and submitted in a single SDL_RenderGeometry
+// call. the atlas has an opaque white cell, so untextured highlights can share that batch.
+class BoardRenderer {
+public:
+    BoardRenderer(SDL_Renderer* renderer, int boardSize, int tileSize, const BoardTheme& theme);
+    ~BoardRenderer();
+
+    BoardRenderer(const BoardRenderer&) = delete;
+    BoardRenderer& operator=(const BoardRenderer&) = delete;
+
+    // decodes <colour>-<piece>.png of all twelve pieces from the asset directory in parallel
+    // and packs them into an atlas image. touches no renderer, so it runs on a worker thread
+    // while the window is being created.
+    static AtlasImage decodePieces(const std::string& directory);
+
+    // uploads a decoded atlas, which must happen on the renderer's thread, and frees its
+    // surface.
+    bool loadPieces(AtlasImage& image);
+
+    SDL_Texture* getAtlas() const {
+        return m_atlas;
+    }
+
+    AtlasRegion getPieceRegion(PieceColour colour, PieceType type) const;
+
+    // target textures are lost when the render device resets, so the layer is redrawn.
+    void invalidateBoardLayer() {
+        m_boardLayerValid = false;
+    }
+
+    // a frame: beginFrame, then for each board drawBoard followed by its squares and pieces
+    // in drawing order, then endFrame. area is the board's rectangle on screen.
+    void beginFrame();
+
+    // copies the cached checkerboard straight away; what is added for it afterwards goes into
+    // the batch that endFrame draws on top.
+    void drawBoard(const SDL_FRect& area);
+
+    void addSquare(const SDL_FRect& area, int square, SDL_Color colour);
+
+    // pieceCode as returned by Board::getPieceCode; 0 draws nothing.
+    void addPiece(const SDL_FRect& area, int square, std::uint8_t pieceCode);
+
+    void endFrame();
+
+    // draw calls issued by the last frame, for the performance panel.
+    int getDrawCalls() const {
+        return m_drawCalls;
+    }
+
+private:
+    void renderBoardLayer();
+    void addQuad(const SDL_FRect& rect, const AtlasRegion& region, SDL_Color colour);
+
+private:
+    SDL_Renderer* m_renderer;
+    int m_boardSize;
+    int m_tileSize;
+    BoardTheme m_theme;
+
+    SDL_Texture* m_atlas;
+    AtlasRegion m_pieceRegions[2][6];
+    AtlasRegion m_whiteRegion;
+
+    SDL_Texture* m_boardLayer;
+    bool m_boardLayerValid;
+
+    // reused every frame; they only grow, so steady-state frames do not allocate.
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;
+    int m_drawCalls;
+    int m_frameDrawCalls;
+};
+
+#endif
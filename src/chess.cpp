@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+#include <future>
 #include <iostream>
 #include <string>
 
@@ -5,10 +8,19 @@
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_sdlrenderer2.h"
 
+#include "assets.hpp"
 #include "chess.hpp"
-#include "movelogic.hpp"
+#include "evaluate.hpp"
+#include "profiler.hpp"
 #include "ui.hpp"
 
+// imgui applies some input a frame late (popups opening, hover state), so a change is drawn
+// for more than one frame.
+constexpr int FRAMES_PER_INVALIDATION = 2;
+
+// taken during static initialisation, as close to launch as the program can see.
+const std::chrono::steady_clock::time_point LAUNCH_TIME = std::chrono::steady_clock::now();
+
 #define ENDS_WITH(str, suffix) \
     (str.size() >= sizeof(suffix) - 1 && str.compare(str.size() - sizeof(suffix) + 1, sizeof(suffix) - 1, suffix) == 0)
 
@@ -16,12 +28,18 @@ Chess::Chess(const GameSpecification& spec)
     : m_window(nullptr)
     , m_renderer(nullptr)
     , m_specification(spec)
-    , m_moveLogic(std::make_unique<MoveLogic>(this))
+    , m_searchService(m_transpositionTable)
+    , m_engineState(EngineState::IDLE)
+    , m_engineGame(-1)
+    , m_engineSearchKey(0)
     , m_ui(nullptr)
-    , m_selectedPiecePosition(-1, -1)
-    , m_boardClickEnabled(true)
-    , m_gameRunning(true)
-    , m_currentTurn(PieceColour::WHITE) {
+    , m_gameRunning(true) {
+
+    // the assets are read and decoded on worker threads while SDL sets up the window, the
+    // renderer and audio; only the uploads to the renderer are left for this thread.
+    IMG_Init(IMG_INIT_PNG);
+    std::future<AtlasImage> pieces = std::async(std::launch::async, BoardRenderer::decodePieces, "images");
+    std::future<Asset> font = std::async(std::launch::async, Asset::load, "fonts/LibreBaskerville-Regular.ttf");
 
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL could not be initialized. SDL_Error: " << SDL_GetError() << std::endl;
@@ -51,442 +69,571 @@ Chess::Chess(const GameSpecification& spec)
     }
 
     // init m_ui now that m_window and m_renderer are not null.
-    m_ui = std::make_unique<UI>(this);
+    m_ui = std::make_unique<UI>(this, font.get());
 
-    loadPieceTextures();
+    AtlasImage pieceImage = pieces.get();
+    loadPieceTextures(pieceImage);
     loadSounds();
+    loadNetwork();
     setupBoard();
 }
 
-void Chess::loadPieceTextures() {
-    std::filesystem::path texturesPath = "resources/images/";
+void Chess::loadPieceTextures(AtlasImage& pieces) {
+    BoardTheme theme = {m_specification.chessTileLightColour, m_specification.chessTileDarkColour};
+    m_boardRenderer = std::make_unique<BoardRenderer>(m_renderer, m_specification.boardSize, m_specification.tileSize, theme);
+
+    if (!m_boardRenderer->loadPieces(pieces)) {
+        exit(1);
+    }
+}
 
-    for (const auto& entry : std::filesystem::directory_iterator(texturesPath)) {
-        if (entry.is_regular_file()) {
-            std::string fileName = entry.path().filename().string();
+void Chess::loadNetwork() {
+    std::filesystem::path networkPath = "resources/nnue/default.nnue";
 
-            if (fileName.find("-") != std::string::npos && ENDS_WITH(fileName, ".png")) {
-                std::string key = fileName.substr(0, fileName.find(".png"));
-                m_textures[key] = loadTexture(entry.path());
-            }
-        }
+    // the network is optional; without one the engine keeps the hand-crafted evaluation.
+    if (std::filesystem::exists(networkPath)) {
+        m_network.load(networkPath.string());
     }
 }
 
 void Chess::loadSounds() {
-    std::filesystem::path soundsPath = "resources/sounds/";
+    for (const std::string& path : listAssets("sounds")) {
+        if (ENDS_WITH(path, ".mp3") || ENDS_WITH(path, ".wav")) {
+            std::size_t nameStart = path.find_last_of('/') + 1;
+            std::string key = path.substr(nameStart, path.find_last_of('.') - nameStart);
+            m_sounds[key].path = path;
+        }
+    }
+}
 
-    for (const auto& entry : std::filesystem::directory_iterator(soundsPath)) {
-        if (entry.is_regular_file()) {
-            std::string fileName = entry.path().filename().string();
+void Chess::setupBoard() {
+    m_searchService.stop();
+    m_engineState = EngineState::IDLE;
+    m_engineGame = -1;
+    m_engineProgress = SearchProgress();
+
+    m_games.clear();
+    m_activeGame = 0;
+    setGameCount(m_specification.gameCount);
+}
 
-            if (ENDS_WITH(fileName, ".mp3") || ENDS_WITH(fileName, ".wav")) {
-                std::string key = fileName.substr(0, fileName.find_last_of('.'));
-                Mix_Chunk* sound = Mix_LoadWAV(entry.path().string().c_str());
+void Chess::setGameCount(int count) {
+    count = std::clamp(count, 1, MAX_GAMES);
 
-                if (!sound) {
-                    std::cerr << "Failed to load sound: " << fileName << ". Mix_Error: " << Mix_GetError() << std::endl;
-                    continue;
-                }
+    if (m_engineGame >= count) {
+        m_searchService.stop();
+        m_engineState = EngineState::IDLE;
+        m_engineGame = -1;
+    }
 
-                m_sounds[key] = sound;
-            }
+    m_games.resize(count);
+    for (std::unique_ptr<Game>& game : m_games) {
+        if (!game) {
+            game = std::make_unique<Game>();
         }
     }
-}
 
-void Chess::setupBoard() {
-    m_board.clear();
-    m_board.resize(m_specification.boardSize, std::vector<Piece>(m_specification.boardSize));
-
-    m_takenWhitePieces = std::array<Piece, 16>{};
-    m_takenBlackPieces = std::array<Piece, 16>{};
-
-    m_currentTurn = PieceColour::WHITE;
-
-    m_board[0][0] = Piece(PieceType::ROOK, PieceColour::BLACK);
-    m_board[0][1] = Piece(PieceType::KNIGHT, PieceColour::BLACK);
-    m_board[0][2] = Piece(PieceType::BISHOP, PieceColour::BLACK);
-    m_board[0][3] = Piece(PieceType::QUEEN, PieceColour::BLACK);
-    m_board[0][4] = Piece(PieceType::KING, PieceColour::BLACK);
-    m_board[0][5] = Piece(PieceType::BISHOP, PieceColour::BLACK);
-    m_board[0][6] = Piece(PieceType::KNIGHT, PieceColour::BLACK);
-    m_board[0][7] = Piece(PieceType::ROOK, PieceColour::BLACK);
-
-    for (int i = 0; i < 8; ++i) {
-        m_board[1][i] = Piece(PieceType::PAWN, PieceColour::BLACK);
-        m_board[6][i] = Piece(PieceType::PAWN, PieceColour::WHITE);
-    }
-
-    m_board[7][0] = Piece(PieceType::ROOK, PieceColour::WHITE);
-    m_board[7][1] = Piece(PieceType::KNIGHT, PieceColour::WHITE);
-    m_board[7][2] = Piece(PieceType::BISHOP, PieceColour::WHITE);
-    m_board[7][3] = Piece(PieceType::QUEEN, PieceColour::WHITE);
-    m_board[7][4] = Piece(PieceType::KING, PieceColour::WHITE);
-    m_board[7][5] = Piece(PieceType::BISHOP, PieceColour::WHITE);
-    m_board[7][6] = Piece(PieceType::KNIGHT, PieceColour::WHITE);
-    m_board[7][7] = Piece(PieceType::ROOK, PieceColour::WHITE);
+    m_specification.gameCount = count;
+    m_activeGame = std::min(m_activeGame, count - 1);
+    m_gridValid = false;
+    invalidate();
 }
 
 void Chess::run() {
+    using Clock = std::chrono::steady_clock;
+
     SDL_Event event;
 
     const int frameDelay = 1000 / m_specification.targetFrameRate;
     Uint32 frameStart;
     int frameTime;
 
+    m_statsStart = Clock::now();
+    invalidate();
+
     while (m_gameRunning) {
         frameStart = SDL_GetTicks();
-
-        while (SDL_PollEvent(&event)) {
-            ImGui_ImplSDL2_ProcessEvent(&event);
-            if (event.type == SDL_QUIT) {
-                m_gameRunning = false;
-                break;
+        Clock::duration idle = {};
+
+        // nothing to draw: sleep until input arrives, waking once per frame only while a
+        // search is running so its progress and result are still picked up.
+        if (m_specification.renderMode == RenderMode::ON_DEMAND && m_framesToRender == 0) {
+            Clock::time_point waitStart = Clock::now();
+            bool received = m_engineState != EngineState::IDLE ? SDL_WaitEventTimeout(&event, frameDelay) != 0
+                                                               : SDL_WaitEvent(&event) != 0;
+            idle += Clock::now() - waitStart;
+
+            if (received) {
+                handleEvent(event);
             }
+        }
 
-            else if (event.type == SDL_MOUSEBUTTONDOWN) {
-                if (event.button.button == SDL_BUTTON_LEFT) {
-                    onBoardClick(event.button.x, event.button.y);
-                }
-            }
+        while (m_gameRunning && SDL_PollEvent(&event)) {
+            handleEvent(event);
         }
 
-        SDL_SetRenderDrawColor(m_renderer, m_specification.windowBackgroundColour.r, m_specification.windowBackgroundColour.g,
-                               m_specification.windowBackgroundColour.b, m_specification.windowBackgroundColour.a);
-        SDL_RenderClear(m_renderer);
+        updateEngine();
 
-        drawBoard();
+        bool rendered = false;
+        if (m_specification.renderMode == RenderMode::CONTINUOUS || m_framesToRender > 0) {
+            m_framesToRender = std::max(m_framesToRender - 1, 0);
+            renderFrame();
+            rendered = true;
 
-        if (!m_possibleMoves.empty()) {
-            drawPossibleMoves();
+            // keep drawing while a widget is held or takes text, e.g. a dragged slider.
+            if (ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput) {
+                m_framesToRender = std::max(m_framesToRender, 1);
+            }
         }
 
-        m_ui->renderInterfaces();
-
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), m_renderer);
-        SDL_RenderPresent(m_renderer);
-
         // limit FPS
         frameTime = SDL_GetTicks() - frameStart;
-        if (frameDelay > frameTime) {
+        if (rendered && frameDelay > frameTime) {
+            Clock::time_point delayStart = Clock::now();
             SDL_Delay(frameDelay - frameTime);
+            idle += Clock::now() - delayStart;
         }
-    }
-}
 
-void Chess::playSound(const std::string& soundName) {
-    auto sound = m_sounds.find(soundName);
-    if (sound != m_sounds.end()) {
-        Mix_PlayChannel(-1, sound->second, 0);
+        updateFrameStats(idle);
     }
 }
 
-SDL_Texture* Chess::loadTexture(const std::filesystem::path& filePath) {
-    SDL_Texture* texture = IMG_LoadTexture(m_renderer, filePath.string().c_str());
-    if (!texture) {
-        std::cerr << "Failed to load texture! SDL_image Error: " << IMG_GetError() << std::endl;
-        exit(1);
-    }
-    return texture;
-}
+void Chess::handleEvent(const SDL_Event& event) {
+    PROFILE_SCOPE("Event handling");
+    PROFILE_COUNT("Events", 1);
 
-void Chess::onBoardClick(int mouseX, int mouseY) {
+    ImGui_ImplSDL2_ProcessEvent(&event);
 
-    if (!m_boardClickEnabled) {
+    if (event.type == SDL_QUIT) {
+        m_gameRunning = false;
         return;
     }
 
-    int col = mouseX / m_specification.tileSize;
-    int row = mouseY / m_specification.tileSize;
-
-    if (!isValidBoardPosition(row, col))
-        return;
-
-    const Piece piece = m_board[row][col];
-    std::cout << "Board Position Click (" << row << ", " << col << ")" << std::endl; // Debug
+    // target textures do not survive a render device reset.
+    if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+        m_boardRenderer->invalidateBoardLayer();
+        m_gridValid = false;
+    }
 
-    if (piece.active && piece.colour == m_currentTurn) {
-        m_selectedPiecePosition = {row, col};
-        m_possibleMoves.clear();
-        m_possibleMoves = m_moveLogic->processPieceMoves(piece, row, col);
+    // the board has no hover effects, so pointer motion only matters to imgui: over its panel
+    // or an open popup, and for the frame that clears the hover when it leaves.
+    if (event.type != SDL_MOUSEMOTION || ImGui::GetIO().WantCaptureMouse ||
+        m_ui->isPointerOverInterface(event.motion.x, event.motion.y)) {
+        invalidate();
+    }
 
-    } else if (isMoveInPossibleMoves(row, col)) {
-        movePiece(row, col);
+    // the panel sits over the board, so a click on one of its widgets must not also select or
+    // move the piece underneath.
+    if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT && !ImGui::GetIO().WantCaptureMouse &&
+        !m_ui->isPointerOverInterface(event.button.x, event.button.y)) {
+        onBoardClick(event.button.x, event.button.y);
     }
 }
 
-bool Chess::isValidBoardPosition(int row, int col) const {
-    return col >= 0 && col < m_specification.boardSize && row >= 0 && row < m_specification.boardSize;
+void Chess::invalidate() {
+    m_framesToRender = std::max(m_framesToRender, FRAMES_PER_INVALIDATION);
 }
 
-bool Chess::isMoveInPossibleMoves(int row, int col) const {
-    for (const auto& move : m_possibleMoves) {
-        if (move.row == row && move.col == col)
-            return true;
+void Chess::updateFrameStats(std::chrono::steady_clock::duration idle) {
+    using Clock = std::chrono::steady_clock;
+
+    m_statsIdle += idle;
+
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_statsStart).count();
+    if (elapsed < 1.0) {
+        return;
     }
-    return false;
+
+    m_frameStats.framesPerSecond = static_cast<float>(m_statsFrames / elapsed);
+    m_frameStats.idlePercent = static_cast<float>(100.0 * std::chrono::duration<double>(m_statsIdle).count() / elapsed);
+
+    m_statsStart = now;
+    m_statsIdle = {};
+    m_statsFrames = 0;
 }
 
-void Chess::checkPawnPromotion(int targetRow, int targetCol) {
-    Piece& piece = m_board[targetRow][targetCol];
-    if (piece.type == PieceType::PAWN) {
-        if ((piece.colour == PieceColour::WHITE && targetRow == 0) || (piece.colour == PieceColour::BLACK && targetRow == 7)) {
-            piece.type = PieceType::QUEEN;
-            std::cout << "Promotion\n";
-            playSound("promotion");
+void Chess::renderFrame() {
+    PROFILE_SCOPE("Frame");
+    ++m_frameStats.framesRendered;
+    ++m_statsFrames;
+
+    SDL_SetRenderDrawColor(m_renderer, m_specification.windowBackgroundColour.r, m_specification.windowBackgroundColour.g,
+                           m_specification.windowBackgroundColour.b, m_specification.windowBackgroundColour.a);
+    SDL_RenderClear(m_renderer);
+
+    {
+        PROFILE_SCOPE("Board drawing");
+        if (m_specification.boardView == BoardView::GRID) {
+            drawGrid();
+        } else {
+            drawBoard();
         }
     }
-}
 
-void Chess::movePiece(int targetRow, int targetCol) {
-    const Piece pieceToMove = m_board[m_selectedPiecePosition.row][m_selectedPiecePosition.col];
+    {
+        PROFILE_SCOPE("ImGui build");
+        m_ui->renderInterfaces();
+    }
 
-    if (isMoveIllegal(m_selectedPiecePosition, {targetRow, targetCol}, pieceToMove.colour)) {
-        playSound("illegal");
-        m_possibleMoves.clear();
-        return;
+    {
+        PROFILE_SCOPE("Present");
+        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), m_renderer);
+        SDL_RenderPresent(m_renderer);
     }
 
-    if (m_board[targetRow][targetCol].type != PieceType::EMPTY) {
+    PROFILE_COUNT("Board draw calls", m_boardRenderer->getDrawCalls());
+    PROFILE_END_FRAME();
 
-        Piece capturedPiece = m_board[targetRow][targetCol];
-        if (capturedPiece.colour == PieceColour::WHITE) {
-            m_takenWhitePieces[m_blackCaptureCount++] = capturedPiece;
-        } else if (capturedPiece.colour == PieceColour::BLACK) {
-            m_takenBlackPieces[m_whiteCaptureCount++] = capturedPiece;
-        }
-        playSound("capture");
-    } else {
-        playSound("move");
+    if (m_frameStats.framesRendered == 1) {
+        m_frameStats.startupMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - LAUNCH_TIME).count();
+        std::cout << "First frame after " << m_frameStats.startupMs << " ms" << std::endl;
     }
+}
 
-    m_board[targetRow][targetCol] = Piece(pieceToMove.type, pieceToMove.colour);
+void Chess::playSound(const std::string& soundName) {
+    auto sound = m_sounds.find(soundName);
+    if (sound == m_sounds.end()) {
+        return;
+    }
 
-    m_board[m_selectedPiecePosition.row][m_selectedPiecePosition.col] = Piece();
+    // a clip is a few kilobytes, so decoding it here costs less than a frame.
+    SoundClip& clip = sound->second;
+    if (!clip.decoded) {
+        clip.decoded = true;
 
-    checkPawnPromotion(targetRow, targetCol);
+        Asset asset = Asset::load(clip.path);
+        if (asset.isLoaded()) {
+            clip.chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(asset.getData(), static_cast<int>(asset.getSize())), 1);
+            if (!clip.chunk) {
+                std::cerr << "Failed to load sound: " << clip.path << ". Mix_Error: " << Mix_GetError() << std::endl;
+            }
+        }
+    }
 
-    m_selectedPiecePosition = {};
-    m_possibleMoves.clear();
+    if (clip.chunk) {
+        Mix_PlayChannel(-1, clip.chunk, 0);
+    }
+}
 
-    PieceColour opponentColour = (pieceToMove.colour == PieceColour::WHITE) ? PieceColour::BLACK : PieceColour::WHITE;
+void Chess::playSounds(unsigned events) {
+    if (events & EVENT_CAPTURE) {
+        playSound("capture");
+    } else if (events & EVENT_MOVE) {
+        playSound("move");
+    }
 
-    if (isInCheck(opponentColour)) {
+    if (events & EVENT_PROMOTION) {
+        playSound("promotion");
+    }
+
+    if (events & EVENT_CHECK) {
         playSound("check");
     }
 
-    if (isCheckmate(opponentColour)) {
+    if (events & EVENT_CHECKMATE) {
         playSound("check");
         playSound("game-end");
-        setupBoard();
+    } else if (events & EVENT_DRAW) {
+        playSound("game-end");
     }
 
-    toggleTurn();
-}
-
-bool Chess::isCheckmate(PieceColour colour) {
-    if (!isInCheck(colour)) {
-        return false;
+    if (events & EVENT_ILLEGAL) {
+        playSound("illegal");
     }
+}
 
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            const Piece& piece = m_board[row][col];
-            if (piece.colour != colour || piece.type == PieceType::EMPTY) {
-                continue;
-            }
+void Chess::onBoardClick(int mouseX, int mouseY) {
+    int gameCount = getGameCount();
+    int gameIndex = m_specification.boardView == BoardView::GRID ? 0 : m_activeGame;
+    int lastIndex = m_specification.boardView == BoardView::GRID ? gameCount - 1 : m_activeGame;
+
+    for (; gameIndex <= lastIndex; ++gameIndex) {
+        SDL_FRect area = getBoardArea(gameIndex);
+        if (mouseX < area.x || mouseX >= area.x + area.w || mouseY < area.y || mouseY >= area.y + area.h) {
+            continue;
+        }
 
-            std::vector<Position> piecePossibleMoves = m_moveLogic->processPieceMoves(piece, row, col);
+        // the first click on another board of the grid only selects that game.
+        if (gameIndex != m_activeGame) {
+            m_activeGame = gameIndex;
+            invalidate();
+            return;
+        }
 
-            if (piecePossibleMoves.empty()) {
-                continue;
-            }
+        if (isEngineTurn(gameIndex)) {
+            return;
+        }
 
-            for (const Position& move : piecePossibleMoves) {
-                if (!isMoveIllegal({row, col}, move, colour)) {
-                    return false;
-                }
-            }
+        const float tile = area.w / m_specification.boardSize;
+        int col = static_cast<int>((mouseX - area.x) / tile);
+        int row = static_cast<int>((mouseY - area.y) / tile);
+        if (col >= m_specification.boardSize || row >= m_specification.boardSize) {
+            return;
         }
-    }
 
-    std::cout << (colour == PieceColour::WHITE ? "White" : "Black") << " is in checkmate!" << std::endl;
-    return true;
+        playSounds(m_games[gameIndex]->onSquareClick(toSquare(row, col)));
+        invalidate();
+        return;
+    }
 }
 
-bool Chess::isMoveIllegal(const Position& from, const Position& to, PieceColour colour) {
-    Piece movingPiece = m_board[from.row][from.col];
+void Chess::promotePawn(PieceType type) {
+    playSounds(m_games[m_activeGame]->promotePawn(type));
+    invalidate();
+}
 
-    Piece originalPiece = m_board[to.row][to.col];
+bool Chess::isEngineTurn(int gameIndex) const {
+    const Game& game = *m_games[gameIndex];
+    return m_engineSettings.enabled && game.getBoard().getSideToMove() == m_engineSettings.engineColour &&
+           !game.isPromotionPending() && !game.getLegalMoves().empty();
+}
 
-    m_board[to.row][to.col] = movingPiece;
-    m_board[from.row][from.col] = Piece(PieceType::EMPTY, PieceColour::WHITE);
+// the game the engine should move in next, taking turns after the last one it searched so
+// that every game waiting on it gets a move; -1 if none is waiting.
+int Chess::findEngineGame() const {
+    int gameCount = getGameCount();
+    for (int offset = 1; offset <= gameCount; ++offset) {
+        int gameIndex = (std::max(m_engineGame, 0) + offset) % gameCount;
+        if (isEngineTurn(gameIndex)) {
+            return gameIndex;
+        }
+    }
+    return -1;
+}
 
-    bool isIllegal = isInCheck(colour);
+// called once per frame. the search runs on the service's thread; this only polls it and
+// starts, redirects or stops searches, so the frame never waits on the engine.
+void Chess::updateEngine() {
+    SearchProgress progress;
+    if (m_searchService.pollProgress(progress)) {
+        m_engineProgress = progress;
+        invalidate();
+    }
 
-    m_board[from.row][from.col] = movingPiece;
-    m_board[to.row][to.col] = originalPiece;
+    // a result only counts if its game still exists and is in the position it was searched for.
+    SearchResult result;
+    if (m_searchService.pollResult(result)) {
+        bool wasThinking = m_engineState == EngineState::THINKING;
+        m_engineState = EngineState::IDLE;
+        invalidate();
 
-    return isIllegal;
-}
+        if (wasThinking && m_engineGame >= 0 && m_engineGame < getGameCount() && isEngineTurn(m_engineGame) &&
+            m_games[m_engineGame]->getBoard().getKey() == m_engineSearchKey) {
+            playEngineMove(result);
+        }
+    }
 
-bool Chess::isInCheck(PieceColour colour) {
-    Position kingPosition = findKing(colour);
+    // resizing waits for the current search to stop, so it only happens when the player
+    // changes the setting, and the search then restarts from scratch.
+    if (m_engineSettings.threads != m_searchService.getThreadCount()) {
+        m_searchService.setThreadCount(m_engineSettings.threads);
+        m_engineState = EngineState::IDLE;
+    }
 
-    if (kingPosition.row == -1) {
-        return false;
+    if (!m_engineSettings.enabled) {
+        if (m_engineState != EngineState::IDLE) {
+            m_searchService.stop();
+            m_engineState = EngineState::IDLE;
+        }
+        return;
     }
 
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            const Piece& piece = m_board[row][col];
+    if (m_engineState != EngineState::IDLE) {
+        bool engineTurn = isEngineTurn(m_engineGame);
 
-            if (piece.type == PieceType::EMPTY || piece.colour == colour) {
-                continue;
-            }
-            m_possibleMoves.clear();
-            m_possibleMoves = m_moveLogic->processPieceMoves(piece, row, col);
-            for (const Position& move : m_possibleMoves) {
-                if (move.row == kingPosition.row && move.col == kingPosition.col) {
-                    return true;
-                }
+        if (engineTurn && m_games[m_engineGame]->getBoard().getKey() == m_engineSearchKey) {
+            // the opponent played the predicted move: the ponder search keeps its tree.
+            if (m_engineState == EngineState::PONDERING) {
+                m_searchService.ponderHit();
+                m_engineState = EngineState::THINKING;
             }
+            return;
         }
+
+        // a ponder search waits for the opponent's move unless other games need the engine.
+        if (m_engineState == EngineState::PONDERING && !engineTurn && getGameCount() == 1) {
+            return;
+        }
+
+        m_searchService.stop();
+        m_engineState = EngineState::IDLE;
     }
 
-    return false;
+    int gameIndex = findEngineGame();
+    if (gameIndex >= 0) {
+        startEngineSearch(gameIndex, m_games[gameIndex]->getBoard(), false);
+    }
 }
 
-void Chess::toggleTurn() {
-    m_possibleMoves.clear();
-    m_currentTurn = (m_currentTurn == PieceColour::WHITE) ? PieceColour::BLACK : PieceColour::WHITE;
+void Chess::startEngineSearch(int gameIndex, const Board& board, bool ponder) {
+    SearchLimits limits;
+    if (m_engineSettings.useTimeLimit) {
+        limits.moveTimeMs = m_engineSettings.moveTimeMs;
+    } else {
+        limits.depth = m_engineSettings.depth;
+    }
+    limits.ponder = ponder;
+
+    SearchOptions options = m_engineSettings.searchOptions;
+    options.network = m_engineSettings.useNnue && m_network.isLoaded() ? &m_network : nullptr;
+
+    m_searchService.setOptions(options);
+    m_searchService.start(board, limits);
+    m_engineGame = gameIndex;
+    m_engineSearchKey = board.getKey();
+    m_engineState = ponder ? EngineState::PONDERING : EngineState::THINKING;
 }
 
-Position Chess::findKing(PieceColour colour) {
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            const Piece& piece = m_board[row][col];
-            if (piece.type == PieceType::KING && piece.colour == colour) {
-                return {row, col};
-            }
-        }
+void Chess::playEngineMove(const SearchResult& result) {
+    Game& game = *m_games[m_engineGame];
+    playSounds(game.playMove(result.bestMove));
+    invalidate();
+
+    // think on the opponent's time, assuming they play the expected reply. with several
+    // games the engine is needed in the others instead.
+    if (m_engineSettings.ponder && getGameCount() == 1 && game.getBoard().getSideToMove() != m_engineSettings.engineColour &&
+        game.getLegalMoves().contains(result.ponderMove)) {
+        Board ponderBoard = game.getBoard();
+        UndoInfo undo;
+        ponderBoard.makeMove(result.ponderMove, undo);
+        startEngineSearch(m_engineGame, ponderBoard, true);
     }
-    return {-1, -1};
 }
 
-void Chess::drawPiece(int col, int row) {
-    const Piece& piece = m_board[row][col];
+SDL_FRect Chess::getBoardArea(int gameIndex) const {
+    const float boardPixels = static_cast<float>(m_specification.boardSize * m_specification.tileSize);
 
-    if (piece.active) {
-        std::string textureKey = getTextureKey(piece);
-        SDL_Texture* texture = m_textures[textureKey];
+    if (m_specification.boardView != BoardView::GRID) {
+        return {0.0f, 0.0f, boardPixels, boardPixels};
+    }
 
-        if (texture) {
-            int x = col * m_specification.tileSize;
-            int y = row * m_specification.tileSize;
-            SDL_Rect destRect = {x, y, m_specification.tileSize, m_specification.tileSize};
+    // the grid fills the same square as the single board, as few columns as fit every game.
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(getGameCount()))));
+    const float cell = boardPixels / columns;
+    const float spacing = std::min(static_cast<float>(m_specification.gridSpacing), cell * 0.25f);
 
-            SDL_RenderCopy(m_renderer, texture, nullptr, &destRect);
-        }
-    }
+    return {(gameIndex % columns) * cell + spacing * 0.5f, (gameIndex / columns) * cell + spacing * 0.5f, cell - spacing,
+            cell - spacing};
 }
 
-void Chess::drawPossibleMoves() {
-    SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
+void Chess::drawGame(const SDL_FRect& area, const Game& game) {
+    const Board& board = game.getBoard();
 
-    SDL_Color transparentGreen = {0, 255, 0, 128};
-    SDL_Rect rect;
+    m_boardRenderer->drawBoard(area);
 
-    for (const auto& move : m_possibleMoves) {
-        rect.x = move.col * m_specification.tileSize;
-        rect.y = move.row * m_specification.tileSize;
-        rect.w = m_specification.tileSize;
-        rect.h = m_specification.tileSize;
+    // the checkers bitboard is maintained by the board, so highlighting a king in check
+    // costs nothing extra per frame.
+    if (board.getCheckers()) {
+        m_boardRenderer->addSquare(area, board.findKing(board.getSideToMove()), m_specification.chessTileCheckColour);
+    }
+
+    Bitboard occupied = board.getOccupancy();
+    while (occupied) {
+        int square = popLsb(occupied);
+        m_boardRenderer->addPiece(area, square, board.getPieceCode(square));
+    }
 
-        SDL_SetRenderDrawColor(m_renderer, transparentGreen.r, transparentGreen.g, transparentGreen.b, transparentGreen.a);
+    if (m_showHangingPieces) {
+        Bitboard hanging = game.getHangingPieces();
+        while (hanging) {
+            m_boardRenderer->addSquare(area, popLsb(hanging), m_specification.hangingPieceColour);
+        }
+    }
 
-        SDL_RenderFillRect(m_renderer, &rect);
+    const SDL_Color transparentGreen = {0, 255, 0, 128};
+    for (const Move& move : game.getPossibleMoves()) {
+        m_boardRenderer->addSquare(area, move.getTo(), transparentGreen);
     }
 }
 
 void Chess::drawBoard() {
-    for (int row = 0; row < m_specification.boardSize; ++row) {
-        for (int col = 0; col < m_specification.boardSize; ++col) {
-            SDL_Color tileColour = getTileColour(row, col);
-            drawTile(col, row, tileColour);
-            drawPiece(col, row);
+    m_boardRenderer->beginFrame();
+    drawGame(getBoardArea(m_activeGame), getActiveGame());
+    m_boardRenderer->endFrame();
+}
+
+// the boards are kept in one target texture and only the games whose version moved on since
+// they were last drawn are drawn again, in a single batch; the frame itself is one copy of
+// the texture. without render targets every board is drawn every frame instead.
+void Chess::drawGrid() {
+    const int gameCount = getGameCount();
+    const int gridPixels = m_specification.boardSize * m_specification.tileSize;
+    const SDL_Color& background = m_specification.windowBackgroundColour;
+
+    if (!m_gridTexture && SDL_RenderTargetSupported(m_renderer)) {
+        m_gridTexture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, gridPixels, gridPixels);
+        if (!m_gridTexture) {
+            std::cerr << "Failed to create the board grid. SDL_Error: " << SDL_GetError() << std::endl;
         }
+        m_gridValid = false;
     }
-}
 
-void Chess::drawTile(int col, int row, SDL_Color colour) {
-    SDL_SetRenderDrawColor(m_renderer, colour.r, colour.g, colour.b, colour.a);
-    int x = col * m_specification.tileSize;
-    int y = row * m_specification.tileSize;
-    SDL_Rect tile = {x, y, m_specification.tileSize, m_specification.tileSize};
-    SDL_RenderFillRect(m_renderer, &tile);
-}
+    if (!m_gridTexture) {
+        m_boardRenderer->beginFrame();
+        for (int gameIndex = 0; gameIndex < gameCount; ++gameIndex) {
+            drawGame(getBoardArea(gameIndex), *m_games[gameIndex]);
+        }
+        m_boardRenderer->endFrame();
+    } else {
+        if (!m_gridValid) {
+            m_drawnVersions.assign(gameCount, 0);
+        }
 
-std::string Chess::getTextureKey(const Piece& piece) const {
-    std::string colourPrefix = (piece.colour == PieceColour::WHITE) ? "white-" : "black-";
-    std::string pieceName;
-
-    switch (piece.type) {
-    case PieceType::PAWN:
-        pieceName = "pawn";
-        break;
-    case PieceType::ROOK:
-        pieceName = "rook";
-        break;
-    case PieceType::KNIGHT:
-        pieceName = "knight";
-        break;
-    case PieceType::BISHOP:
-        pieceName = "bishop";
-        break;
-    case PieceType::QUEEN:
-        pieceName = "queen";
-        break;
-    case PieceType::KING:
-        pieceName = "king";
-        break;
-    default:
-        pieceName = "unknown";
-        break;
-    }
-
-    return colourPrefix + pieceName;
-}
+        bool changed = false;
+        for (int gameIndex = 0; gameIndex < gameCount && !changed; ++gameIndex) {
+            changed = m_drawnVersions[gameIndex] != m_games[gameIndex]->getVersion();
+        }
+
+        if (changed) {
+            SDL_SetRenderTarget(m_renderer, m_gridTexture);
+            if (!m_gridValid) {
+                SDL_SetRenderDrawColor(m_renderer, background.r, background.g, background.b, background.a);
+                SDL_RenderClear(m_renderer);
+            }
+
+            m_boardRenderer->beginFrame();
+            for (int gameIndex = 0; gameIndex < gameCount; ++gameIndex) {
+                if (m_drawnVersions[gameIndex] != m_games[gameIndex]->getVersion()) {
+                    drawGame(getBoardArea(gameIndex), *m_games[gameIndex]);
+                    m_drawnVersions[gameIndex] = m_games[gameIndex]->getVersion();
+                }
+            }
+            m_boardRenderer->endFrame();
+
+            SDL_SetRenderTarget(m_renderer, nullptr);
+        }
+        m_gridValid = true;
 
-SDL_Texture* Chess::getTexture(const std::string& textureKey) const {
-    auto it = m_textures.find(textureKey);
-    if (it != m_textures.end()) {
-        return it->second;
+        SDL_Rect target = {0, 0, gridPixels, gridPixels};
+        SDL_RenderCopy(m_renderer, m_gridTexture, nullptr, &target);
     }
-    return nullptr;
-}
 
-SDL_Color Chess::getTileColour(int row, int col) {
-    return (row % 2 == col % 2) ? m_specification.chessTileLightColour : m_specification.chessTileDarkColour;
+    const SDL_Color& outline = m_specification.activeBoardColour;
+    SDL_FRect active = getBoardArea(m_activeGame);
+    SDL_SetRenderDrawColor(m_renderer, outline.r, outline.g, outline.b, outline.a);
+    SDL_RenderDrawRectF(m_renderer, &active);
 }
 
 Chess::~Chess() {
-    for (auto& texture : m_textures) {
-        SDL_DestroyTexture(texture.second);
-    }
-
     for (auto& sound : m_sounds) {
-        Mix_FreeChunk(sound.second);
+        if (sound.second.chunk) {
+            Mix_FreeChunk(sound.second.chunk);
+        }
     }
 
     m_sounds.clear();
-    m_textures.clear();
+    m_boardRenderer.reset();
+
+    if (m_gridTexture) {
+        SDL_DestroyTexture(m_gridTexture);
+    }
 
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
     SDL_DestroyRenderer(m_renderer);
     SDL_DestroyWindow(m_window);
+    IMG_Quit();
     SDL_Quit();
 }
@@ -2,36 +2,100 @@
 #define CHESS_HPP
 
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
 
+#include "board.hpp"
+#include "boardrenderer.hpp"
+#include "evaluate.hpp"
+#include "game.hpp"
+#include "move.hpp"
+#include "nnue.hpp"
 #include "piece.hpp"
+#include "search.hpp"
+#include "searchservice.hpp"
+#include "transpositiontable.hpp"
 #include "ui.hpp"
 
-struct Position {
-    int row, col;
-
-    Position()
-        : row(0)
-        , col(0) {}
+// ON_DEMAND sleeps until an event arrives and only redraws when something changed: input, a
+// move, engine progress or a widget that is being interacted with. CONTINUOUS redraws at
+// targetFrameRate whether or not anything changed.
+enum class RenderMode {
+    CONTINUOUS,
+    ON_DEMAND,
+};
 
-    Position(int r, int c)
-        : row(r)
-        , col(c) {}
+// SINGLE draws the active game full size. GRID shows every game as a scaled board, clicking one
+// makes it the active game.
+enum class BoardView {
+    SINGLE,
+    GRID,
 };
 
+constexpr int MAX_GAMES = 64;
+
 struct GameSpecification {
     SDL_Color chessTileLightColour = {222, 184, 135, 255};
     SDL_Color chessTileDarkColour = {139, 69, 19, 255};
+    SDL_Color chessTileCheckColour = {200, 40, 40, 255};
+    SDL_Color hangingPieceColour = {255, 140, 0, 110};
     SDL_Color windowBackgroundColour = {18, 18, 18, 255};
     int tileSize = 90;
     int boardSize = 8;
     int targetFrameRate = 60;
+    RenderMode renderMode = RenderMode::ON_DEMAND;
+    int gameCount = 1;
+    BoardView boardView = BoardView::SINGLE;
+    // space between boards in the grid, in pixels.
+    int gridSpacing = 6;
+    SDL_Color activeBoardColour = {240, 200, 60, 255};
+};
+
+// main loop counters, sampled over roughly one second so the saving of on-demand rendering
+// can be seen. idle is the share of wall time the main thread spent waiting for events or
+// sleeping off the frame limit.
+struct FrameStats {
+    // from process start until the first frame was presented.
+    float startupMs = 0.0f;
+    std::uint64_t framesRendered = 0;
+    float framesPerSecond = 0.0f;
+    float idlePercent = 0.0f;
+};
+
+// the engine plays one side when enabled, in every game it hosts one after another, limited either by time per move or by depth.
+struct EngineSettings {
+    bool enabled = false;
+    PieceColour engineColour = PieceColour::BLACK;
+    bool useTimeLimit = true;
+    int moveTimeMs = 1000;
+    int depth = 6;
+    bool ponder = false;
+    int threads = 1;
+    // only takes effect when a network was found at startup.
+    bool useNnue = false;
+    SearchOptions searchOptions;
+};
+
+// a sound is only decoded the first time it is played.
+struct SoundClip {
+    std::string path;
+    Mix_Chunk* chunk = nullptr;
+    bool decoded = false;
+};
+
+enum class EngineState {
+    IDLE,
+    THINKING,
+    PONDERING,
 };
 
 class Chess {
@@ -41,12 +105,13 @@ public:
     void run();
 
 public:
-    std::string getTextureKey(const Piece& piece) const;
-    SDL_Texture* getTexture(const std::string& textureKey) const;
+    // the panel always shows the active game.
+    const Game& getActiveGame() const {
+        return *m_games[m_activeGame];
+    }
 
-public:
-    const std::vector<std::vector<Piece>>& getBoard() const {
-        return m_board;
+    const Board& getBoard() const {
+        return getActiveGame().getBoard();
     }
     int getBoardSize() const {
         return m_specification.boardSize;
@@ -60,57 +125,142 @@ public:
         return m_renderer;
     }
 
+    const BoardRenderer& getBoardRenderer() const {
+        return *m_boardRenderer;
+    }
+
     PieceColour getCurrentTurn() const {
-        return m_currentTurn;
+        return getBoard().getSideToMove();
     }
 
     const std::array<Piece, 16>& getTakenWhitePieces() const {
-        return m_takenWhitePieces;
+        return getActiveGame().getTakenWhitePieces();
     }
     const std::array<Piece, 16>& getTakenBlackPieces() const {
-        return m_takenBlackPieces;
+        return getActiveGame().getTakenBlackPieces();
+    }
+
+    bool isPromotionPending() const {
+        return getActiveGame().isPromotionPending();
+    }
+
+    void promotePawn(PieceType type);
+
+    bool isShowingHangingPieces() const {
+        return m_showHangingPieces;
+    }
+
+    void setShowHangingPieces(bool show) {
+        m_showHangingPieces = show;
+        m_gridValid = false;
+    }
+
+    // static evaluation of the active game, refreshed once per move.
+    const EvalTrace& getEvaluation() const {
+        return getActiveGame().getEvaluation();
+    }
+
+    int getGameCount() const {
+        return static_cast<int>(m_games.size());
+    }
+
+    // new games start from the initial position; removing games drops the last ones.
+    void setGameCount(int count);
+
+    BoardView getBoardView() const {
+        return m_specification.boardView;
+    }
+
+    void setBoardView(BoardView view) {
+        m_specification.boardView = view;
+        m_gridValid = false;
+    }
+
+    EngineSettings& getEngineSettings() {
+        return m_engineSettings;
+    }
+
+    const NnueNetwork& getNetwork() const {
+        return m_network;
+    }
+
+    EngineState getEngineState() const {
+        return m_engineState;
+    }
+
+    RenderMode getRenderMode() const {
+        return m_specification.renderMode;
+    }
+
+    void setRenderMode(RenderMode mode) {
+        m_specification.renderMode = mode;
+    }
+
+    const FrameStats& getFrameStats() const {
+        return m_frameStats;
+    }
+
+    // latest snapshot polled from the search thread, including while it is still thinking.
+    const SearchProgress& getEngineProgress() const {
+        return m_engineProgress;
     }
 
 private:
+    void handleEvent(const SDL_Event& event);
+    void renderFrame();
+
+    // the next few frames are drawn even in on-demand mode.
+    void invalidate();
+    void updateFrameStats(std::chrono::steady_clock::duration idle);
+
     void drawBoard();
+    void drawGrid();
+    void drawGame(const SDL_FRect& area, const Game& game);
+    SDL_FRect getBoardArea(int gameIndex) const;
     void setupBoard();
-    void loadPieceTextures();
+    void loadPieceTextures(AtlasImage& pieces);
     void loadSounds();
+    void loadNetwork();
     void onBoardClick(int mouseX, int mouseY);
-    bool isValidBoardPosition(int row, int col) const;
-    bool isMoveInPossibleMoves(int row, int col) const;
-    void checkPawnPromotion(int targetRow, int targetCol);
-    void movePiece(int targetRow, int targetCol);
-    void toggleTurn();
-    bool isCheckmate(PieceColour colour);
-    bool isMoveIllegal(const Position& from, const Position& to, PieceColour colour);
-    bool isInCheck(PieceColour colour);
-    void drawTile(int col, int row, SDL_Color colour);
+    bool isEngineTurn(int gameIndex) const;
+    int findEngineGame() const;
+    void updateEngine();
+    void startEngineSearch(int gameIndex, const Board& board, bool ponder);
+    void playEngineMove(const SearchResult& result);
     void playSound(const std::string& soundName);
-    void drawPiece(int col, int row);
-    void drawPossibleMoves();
-    Position findKing(PieceColour colour);
-    SDL_Color getTileColour(int row, int col);
-    SDL_Texture* loadTexture(const std::filesystem::path& filePath);
+    void playSounds(unsigned events);
 
 private:
-    int m_whiteCaptureCount = 0;
-    int m_blackCaptureCount = 0;
-    bool m_boardClickEnabled;
     bool m_gameRunning;
+    bool m_showHangingPieces = false;
+
+    int m_framesToRender = 0;
+    FrameStats m_frameStats;
+    std::chrono::steady_clock::time_point m_statsStart;
+    std::chrono::steady_clock::duration m_statsIdle = {};
+    std::uint64_t m_statsFrames = 0;
 
-    Position m_selectedPiecePosition;
-    PieceColour m_currentTurn;
     GameSpecification m_specification;
 
-    std::vector<Position> m_possibleMoves;
-    std::vector<std::vector<Piece>> m_board;
-    std::unordered_map<std::string, Mix_Chunk*> m_sounds;
-    std::unordered_map<std::string, SDL_Texture*> m_textures;
-    std::array<Piece, 16> m_takenWhitePieces;
-    std::array<Piece, 16> m_takenBlackPieces;
-    std::unique_ptr<class MoveLogic> m_moveLogic;
+    std::vector<std::unique_ptr<Game>> m_games;
+    int m_activeGame = 0;
+
+    // every board of the grid view, redrawn per cell when that game's version moves on.
+    SDL_Texture* m_gridTexture = nullptr;
+    bool m_gridValid = false;
+    std::vector<std::uint64_t> m_drawnVersions;
+
+    TranspositionTable m_transpositionTable;
+    NnueNetwork m_network;
+    SearchService m_searchService;
+    EngineSettings m_engineSettings;
+    EngineState m_engineState;
+    int m_engineGame;
+    std::uint64_t m_engineSearchKey;
+    SearchProgress m_engineProgress;
+    std::unordered_map<std::string, SoundClip> m_sounds;
     std::unique_ptr<class UI> m_ui;
+    std::unique_ptr<BoardRenderer> m_boardRenderer;
 
     SDL_Window* m_window;
     SDL_Renderer* m_renderer;
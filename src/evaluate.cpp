@@ -0,0 +1,234 @@
+#include "evaluate.hpp"
+#include "attacks.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr Score DOUBLED_PAWN = {-10, -20};
+constexpr Score ISOLATED_PAWN = {-10, -15};
+constexpr Score BACKWARD_PAWN = {-8, -10};
+constexpr Score SUPPORTED_PAWN = {6, 8};
+
+// passed pawn bonus by rank from the pawn's own side.
+constexpr Score PASSED_PAWN[8] = {{0, 0}, {5, 10}, {5, 15}, {10, 25}, {20, 45}, {35, 75}, {60, 120}, {0, 0}};
+
+// extra for a passed pawn whose path to promotion is empty, by the same rank.
+constexpr Score FREE_PASSED_PAWN[8] = {{0, 0}, {0, 0}, {0, 5}, {0, 10}, {5, 20}, {10, 35}, {15, 60}, {0, 0}};
+
+constexpr Score BISHOP_PAIR = {30, 50};
+
+// per reachable square, centred on a typical square count so an average piece scores zero.
+constexpr Score MOBILITY_WEIGHT[6] = {{0, 0}, {2, 4}, {4, 4}, {5, 5}, {1, 2}, {0, 0}};
+constexpr int MOBILITY_BASE[6] = {0, 6, 4, 6, 12, 0};
+
+// king danger units per attacked king-zone square, by attacker type.
+constexpr int KING_ATTACK_WEIGHT[6] = {0, 3, 2, 2, 5, 0};
+constexpr int MAX_KING_DANGER = 500;
+
+constexpr Score SHIELD_PAWN_NEAR = {15, 0};
+constexpr Score SHIELD_PAWN_FAR = {8, 0};
+constexpr Score SHIELD_MISSING = {-15, 0};
+
+Bitboard fileMask(int square) {
+    return FILE_A << squareCol(square);
+}
+
+Bitboard adjacentFilesMask(int square) {
+    Bitboard file = fileMask(square);
+    return shiftEast(file) | shiftWest(file);
+}
+
+// every rank strictly in front of square, seen from colour.
+Bitboard forwardRanks(int colour, int square) {
+    int rank = squareRank(square);
+    if (colour == 0) {
+        return rank == 7 ? 0 : ~0ULL << (8 * (rank + 1));
+    }
+    return (1ULL << (8 * rank)) - 1;
+}
+
+Bitboard pawnAttackSpan(int colour, Bitboard pawns) {
+    return colour == 0 ? shiftNorth(shiftEast(pawns) | shiftWest(pawns)) : shiftSouth(shiftEast(pawns) | shiftWest(pawns));
+}
+
+int relativeRank(int colour, int square) {
+    return colour == 0 ? squareRank(square) : 7 - squareRank(square);
+}
+
+Score evaluatePawnsFor(const Board& board, int colour, Bitboard& passedPawns) {
+    Bitboard ours = board.getPieces(colourFromIndex(colour), PieceType::PAWN);
+    Bitboard theirs = board.getPieces(colourFromIndex(colour ^ 1), PieceType::PAWN);
+    Bitboard supported = pawnAttackSpan(colour, ours);
+    Bitboard enemyAttacks = pawnAttackSpan(colour ^ 1, theirs);
+
+    Score score;
+    Bitboard pawns = ours;
+    while (pawns) {
+        int square = popLsb(pawns);
+        Bitboard ahead = forwardRanks(colour, square);
+        Bitboard neighbours = ours & adjacentFilesMask(square);
+
+        if (ours & fileMask(square) & ahead) {
+            score += DOUBLED_PAWN;
+        }
+        if (neighbours == 0) {
+            score += ISOLATED_PAWN;
+        } else if ((neighbours & ~ahead) == 0 && (enemyAttacks & squareBit(colour == 0 ? square + 8 : square - 8))) {
+            // every neighbour has already advanced past it and it cannot step up safely.
+            score += BACKWARD_PAWN;
+        }
+        if ((theirs & (fileMask(square) | adjacentFilesMask(square)) & ahead) == 0) {
+            score += PASSED_PAWN[relativeRank(colour, square)];
+            passedPawns |= squareBit(square);
+        }
+        if (supported & squareBit(square)) {
+            score += SUPPORTED_PAWN;
+        }
+    }
+
+    return score;
+}
+
+// the part of the passed pawn terms that depends on other pieces, so it is not cached.
+Score evaluatePassedPawns(const Board& board, int colour, Bitboard passedPawns) {
+    Score score;
+    while (passedPawns) {
+        int square = popLsb(passedPawns);
+        if ((board.getOccupancy() & fileMask(square) & forwardRanks(colour, square)) == 0) {
+            score += FREE_PASSED_PAWN[relativeRank(colour, square)];
+        }
+    }
+    return score;
+}
+
+Bitboard getPieceAttacks(PieceType type, int square, Bitboard occupied) {
+    switch (type) {
+    case PieceType::KNIGHT:
+        return getKnightAttacks(square);
+    case PieceType::BISHOP:
+        return getBishopAttacks(square, occupied);
+    case PieceType::ROOK:
+        return getRookAttacks(square, occupied);
+    default:
+        return getQueenAttacks(square, occupied);
+    }
+}
+
+// mobility of colour's pieces and the pressure they put on the enemy king zone.
+void evaluateActivity(const Board& board, int colour, Score& mobility, Score& kingAttack) {
+    PieceColour us = colourFromIndex(colour);
+    PieceColour them = colourFromIndex(colour ^ 1);
+    Bitboard occupied = board.getOccupancy();
+
+    // squares not taken by our own pieces and not covered by enemy pawns.
+    Bitboard mobilityArea = ~board.getOccupancy(us) & ~pawnAttackSpan(colour ^ 1, board.getPieces(them, PieceType::PAWN));
+
+    int enemyKing = board.findKing(them);
+    Bitboard kingZone = getKingAttacks(enemyKing) | squareBit(enemyKing);
+
+    int attackers = 0;
+    int danger = 0;
+
+    for (PieceType type : {PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN}) {
+        int index = pieceIndex(type);
+        Bitboard pieces = board.getPieces(us, type);
+        while (pieces) {
+            Bitboard attacks = getPieceAttacks(type, popLsb(pieces), occupied);
+            mobility += MOBILITY_WEIGHT[index] * (popCount(attacks & mobilityArea) - MOBILITY_BASE[index]);
+
+            if (attacks & kingZone) {
+                ++attackers;
+                danger += KING_ATTACK_WEIGHT[index] * popCount(attacks & kingZone);
+            }
+        }
+    }
+
+    // a single attacker is rarely dangerous; beyond that danger grows quadratically.
+    if (attackers >= 2) {
+        kingAttack += Score(std::min(danger * danger / 4, MAX_KING_DANGER), 0);
+    }
+}
+
+// pawn shield on the three files around a king that still sits on its first two ranks.
+Score evaluateShelter(const Board& board, int colour) {
+    PieceColour us = colourFromIndex(colour);
+    int king = board.findKing(us);
+    if (relativeRank(colour, king) > 1) {
+        return Score();
+    }
+
+    Bitboard pawns = board.getPieces(us, PieceType::PAWN);
+    Bitboard files = fileMask(king) | adjacentFilesMask(king);
+    Bitboard near = colour == 0 ? shiftNorth(RANK_1 << (8 * squareRank(king))) : shiftSouth(RANK_1 << (8 * squareRank(king)));
+    Bitboard far = colour == 0 ? shiftNorth(near) : shiftSouth(near);
+
+    Score score;
+    Bitboard fileSet = files & RANK_1;
+    while (fileSet) {
+        Bitboard file = fileMask(popLsb(fileSet));
+        if (pawns & file & near) {
+            score += SHIELD_PAWN_NEAR;
+        } else if (pawns & file & far) {
+            score += SHIELD_PAWN_FAR;
+        } else {
+            score += SHIELD_MISSING;
+        }
+    }
+
+    return score;
+}
+
+EvalTrace evaluateTerms(const Board& board, const PawnEntry& pawns) {
+    EvalTrace trace;
+    trace.psqt = board.getPsqtScore();
+    trace.pawns = pawns.score + evaluatePassedPawns(board, 0, pawns.passedPawns[0]) -
+                  evaluatePassedPawns(board, 1, pawns.passedPawns[1]);
+
+    for (int colour = 0; colour < 2; ++colour) {
+        Score pieces, mobility, kingSafety;
+        if (moreThanOne(board.getPieces(colourFromIndex(colour), PieceType::BISHOP))) {
+            pieces += BISHOP_PAIR;
+        }
+        evaluateActivity(board, colour, mobility, kingSafety);
+        kingSafety += evaluateShelter(board, colour);
+
+        if (colour == 0) {
+            trace.pieces += pieces;
+            trace.mobility += mobility;
+            trace.kingSafety += kingSafety;
+        } else {
+            trace.pieces -= pieces;
+            trace.mobility -= mobility;
+            trace.kingSafety -= kingSafety;
+        }
+    }
+
+    Score total = trace.psqt + trace.pawns + trace.pieces + trace.mobility + trace.kingSafety;
+    trace.phase = std::min(board.getPhase(), MAX_PHASE);
+    trace.total = (total.mg * trace.phase + total.eg * (MAX_PHASE - trace.phase)) / MAX_PHASE;
+    return trace;
+}
+
+} // namespace
+
+PawnEntry evaluatePawns(const Board& board) {
+    PawnEntry entry;
+    entry.key = board.getPawnKey();
+    entry.score = evaluatePawnsFor(board, 0, entry.passedPawns[0]) - evaluatePawnsFor(board, 1, entry.passedPawns[1]);
+    return entry;
+}
+
+EvalTrace traceEvaluation(const Board& board) {
+    return evaluateTerms(board, evaluatePawns(board));
+}
+
+int evaluate(const Board& board) {
+    int score = evaluateTerms(board, evaluatePawns(board)).total;
+    return board.getSideToMove() == PieceColour::WHITE ? score : -score;
+}
+
+int evaluate(const Board& board, PawnHashTable& pawnTable) {
+    int score = evaluateTerms(board, pawnTable.probe(board)).total;
+    return board.getSideToMove() == PieceColour::WHITE ? score : -score;
+}
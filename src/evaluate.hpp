@@ -0,0 +1,40 @@
+#ifndef EVALUATE_HPP
+#define EVALUATE_HPP
+
+#include "board.hpp"
+#include "pawnhash.hpp"
+#include "psqt.hpp"
+
+// centipawn values indexed by pieceIndex: pawn, rook, knight, bishop, queen, king. used for
+// move ordering and exchange evaluation; the evaluation has its own tapered material.
+constexpr int PIECE_VALUES[6] = {100, 500, 320, 330, 900, 0};
+
+inline int getPieceValue(PieceType type) {
+    return type == PieceType::EMPTY ? 0 : PIECE_VALUES[pieceIndex(type)];
+}
+
+// the evaluation split into its terms, all from white's point of view.
+struct EvalTrace {
+    Score psqt;
+    Score pawns;
+    Score pieces;
+    Score mobility;
+    Score kingSafety;
+    int phase;
+    int total;
+};
+
+// static evaluation in centipawns from the side to move's point of view.
+int evaluate(const Board& board);
+
+// the same, with the pawn structure looked up in (or added to) pawnTable.
+int evaluate(const Board& board, PawnHashTable& pawnTable);
+
+// the same evaluation with every term kept, for display. total is from white's point of view.
+EvalTrace traceEvaluation(const Board& board);
+
+// pawn structure only (doubled, isolated, backward, passed and supported pawns), white's point
+// of view, plus the passed pawns of each side. depends on nothing but the pawns.
+PawnEntry evaluatePawns(const Board& board);
+
+#endif
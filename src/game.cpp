@@ -0,0 +1,163 @@
+#include "game.hpp"
+
+#include <iostream>
+
+#include "movelogic.hpp"
+#include "profiler.hpp"
+#include "see.hpp"
+
+Game::Game()
+    : m_hangingPieces(0)
+    , m_evaluation{}
+    , m_whiteCaptureCount(0)
+    , m_blackCaptureCount(0)
+    , m_version(0) {
+    reset();
+}
+
+void Game::reset() {
+    m_board.setupStartPosition();
+    m_possibleMoves.clear();
+    m_pendingPromotion = Move();
+    updateLegalMoves();
+
+    m_takenWhitePieces = std::array<Piece, 16>{};
+    m_takenBlackPieces = std::array<Piece, 16>{};
+    m_whiteCaptureCount = 0;
+    m_blackCaptureCount = 0;
+
+    ++m_version;
+}
+
+unsigned Game::onSquareClick(int square) {
+    if (isPromotionPending()) {
+        return EVENT_NONE;
+    }
+
+    const Piece piece = m_board.getPiece(square);
+
+    if (piece.active && piece.colour == m_board.getSideToMove()) {
+        PROFILE_SCOPE("Move generation");
+        m_possibleMoves.clear();
+        MoveLogic::generatePieceMoves(m_board, square, m_possibleMoves);
+        ++m_version;
+        return EVENT_NONE;
+    }
+
+    Move move;
+    for (const Move& possibleMove : m_possibleMoves) {
+        if (possibleMove.getTo() == square) {
+            move = possibleMove;
+            break;
+        }
+    }
+
+    if (move.isNull()) {
+        return EVENT_NONE;
+    }
+
+    // all four promotions share a target square, so wait for the UI to pick one.
+    if (move.isPromotion() && m_legalMoves.contains(move)) {
+        m_pendingPromotion = move;
+        ++m_version;
+        return EVENT_NONE;
+    }
+
+    return playMove(move);
+}
+
+unsigned Game::promotePawn(PieceType type) {
+    if (m_pendingPromotion.isNull()) {
+        return EVENT_NONE;
+    }
+
+    Move move(m_pendingPromotion.getFrom(), m_pendingPromotion.getTo(), promotionFlag(type, m_pendingPromotion.isCapture()));
+    m_pendingPromotion = Move();
+
+    return playMove(move);
+}
+
+unsigned Game::playMove(Move move) {
+    ++m_version;
+
+    if (!m_legalMoves.contains(move)) {
+        m_possibleMoves.clear();
+        return EVENT_ILLEGAL;
+    }
+
+    const PieceColour opponentColour = oppositeColour(m_board.getSideToMove());
+    unsigned events = EVENT_MOVE;
+
+    UndoInfo undo;
+    m_board.makeMove(move, undo);
+
+    if (undo.capturedPiece != 0) {
+        Piece capturedPiece = Board::decodePiece(undo.capturedPiece);
+        if (capturedPiece.colour == PieceColour::WHITE) {
+            m_takenWhitePieces[m_blackCaptureCount++] = capturedPiece;
+        } else if (capturedPiece.colour == PieceColour::BLACK) {
+            m_takenBlackPieces[m_whiteCaptureCount++] = capturedPiece;
+        }
+        events |= EVENT_CAPTURE;
+    }
+
+    if (move.isPromotion()) {
+        events |= EVENT_PROMOTION;
+    }
+
+    m_possibleMoves.clear();
+    updateLegalMoves();
+
+    {
+        PROFILE_SCOPE("Check and game end detection");
+        if (m_board.isInCheck(opponentColour)) {
+            events |= EVENT_CHECK;
+        }
+
+        const char* colourName = opponentColour == PieceColour::WHITE ? "White" : "Black";
+        if (m_legalMoves.empty() && (events & EVENT_CHECK)) {
+            std::cout << colourName << " is in checkmate!" << std::endl;
+            events |= EVENT_CHECKMATE;
+        } else if (m_legalMoves.empty()) {
+            std::cout << colourName << " is in stalemate!" << std::endl;
+            events |= EVENT_DRAW;
+        } else if (isDrawByRule()) {
+            events |= EVENT_DRAW;
+        }
+    }
+
+    if (events & (EVENT_CHECKMATE | EVENT_DRAW)) {
+        reset();
+    }
+
+    return events;
+}
+
+void Game::updateLegalMoves() {
+    {
+        PROFILE_SCOPE("Move generation");
+        m_legalMoves.clear();
+        MoveLogic::generateLegalMoves(m_board, m_legalMoves);
+        PROFILE_COUNT("Legal moves generated", m_legalMoves.size());
+    }
+
+    PROFILE_SCOPE("Hanging pieces and evaluation");
+
+    // once per ply rather than per frame, for both sides.
+    m_hangingPieces = ::getHangingPieces(m_board, PieceColour::WHITE) | ::getHangingPieces(m_board, PieceColour::BLACK);
+    m_evaluation = traceEvaluation(m_board);
+}
+
+bool Game::isDrawByRule() const {
+    if (m_board.isRepetition(2)) {
+        std::cout << "Draw by threefold repetition!" << std::endl;
+        return true;
+    }
+
+    if (m_board.isFiftyMoveRule()) {
+        std::cout << "Draw by the fifty-move rule!" << std::endl;
+        return true;
+    }
+
+    return false;
+}
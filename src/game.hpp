@@ -0,0 +1,102 @@
+#ifndef GAME_HPP
+#define GAME_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "bitboard.hpp"
+#include "board.hpp"
+#include "evaluate.hpp"
+#include "move.hpp"
+#include "piece.hpp"
+
+// what a click or move did, as flags, so the window can play the matching sounds.
+enum GameEvent : unsigned {
+    EVENT_NONE = 0,
+    EVENT_MOVE = 1 << 0,
+    EVENT_CAPTURE = 1 << 1,
+    EVENT_PROMOTION = 1 << 2,
+    EVENT_CHECK = 1 << 3,
+    EVENT_CHECKMATE = 1 << 4,
+    EVENT_DRAW = 1 << 5,
+    EVENT_ILLEGAL = 1 << 6,
+};
+
+// one game: the position, the player's selection and everything derived from the position
+// once per move. no SDL, so any number of them can be played or watched by one window.
+// a finished game starts again from the initial position.
+class Game {
+public:
+    Game();
+
+    void reset();
+
+    // a click on square: selects a piece of the side to move, or plays the selected piece
+    // there. a promotion waits for promotePawn.
+    unsigned onSquareClick(int square);
+    unsigned promotePawn(PieceType type);
+
+    // plays move if it is legal, for the player or the engine.
+    unsigned playMove(Move move);
+
+    const Board& getBoard() const {
+        return m_board;
+    }
+
+    const MoveList& getLegalMoves() const {
+        return m_legalMoves;
+    }
+
+    // moves of the selected piece, for highlighting.
+    const MoveList& getPossibleMoves() const {
+        return m_possibleMoves;
+    }
+
+    Bitboard getHangingPieces() const {
+        return m_hangingPieces;
+    }
+
+    // static evaluation of the current position, refreshed once per move.
+    const EvalTrace& getEvaluation() const {
+        return m_evaluation;
+    }
+
+    const std::array<Piece, 16>& getTakenWhitePieces() const {
+        return m_takenWhitePieces;
+    }
+
+    const std::array<Piece, 16>& getTakenBlackPieces() const {
+        return m_takenBlackPieces;
+    }
+
+    bool isPromotionPending() const {
+        return !m_pendingPromotion.isNull();
+    }
+
+    // bumped by every change that shows on the board, so a view can tell which boards need
+    // drawing again.
+    std::uint64_t getVersion() const {
+        return m_version;
+    }
+
+private:
+    void updateLegalMoves();
+    bool isDrawByRule() const;
+
+private:
+    Board m_board;
+    MoveList m_legalMoves;
+    MoveList m_possibleMoves;
+    Move m_pendingPromotion;
+    Bitboard m_hangingPieces;
+    EvalTrace m_evaluation;
+
+    std::array<Piece, 16> m_takenWhitePieces;
+    std::array<Piece, 16> m_takenBlackPieces;
+    int m_whiteCaptureCount;
+    int m_blackCaptureCount;
+
+    std::uint64_t m_version;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef MOVE_HPP
+#define MOVE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "piece.hpp"
+
+enum MoveFlag : std::uint16_t {
+    QUIET_MOVE = 0,
+    DOUBLE_PAWN_PUSH = 1,
+    KING_CASTLE = 2,
+    QUEEN_CASTLE = 3,
+    CAPTURE = 4,
+    EN_PASSANT = 5,
+    KNIGHT_PROMOTION = 8,
+    BISHOP_PROMOTION = 9,
+    ROOK_PROMOTION = 10,
+    QUEEN_PROMOTION = 11,
+    KNIGHT_PROMOTION_CAPTURE = 12,
+    BISHOP_PROMOTION_CAPTURE = 13,
+    ROOK_PROMOTION_CAPTURE = 14,
+    QUEEN_PROMOTION_CAPTURE = 15,
+};
+
+constexpr int promotionFlag(PieceType type, bool capture) {
+    int flag = type == PieceType::KNIGHT ? KNIGHT_PROMOTION
+               : type == PieceType::BISHOP ? BISHOP_PROMOTION
+               : type == PieceType::ROOK   ? ROOK_PROMOTION
+                                           : QUEEN_PROMOTION;
+    return capture ? flag | CAPTURE : flag;
+}
+
+// 16-bit move: bits 0-5 from square, bits 6-11 to square, bits 12-15 MoveFlag.
+class Move {
+public:
+    constexpr Move()
+        : m_data(0) {}
+
+    constexpr Move(int from, int to, int flags = QUIET_MOVE)
+        : m_data(static_cast<std::uint16_t>(from | (to << 6) | (flags << 12))) {}
+
+    constexpr int getFrom() const {
+        return m_data & 0x3F;
+    }
+
+    constexpr int getTo() const {
+        return (m_data >> 6) & 0x3F;
+    }
+
+    constexpr int getFlags() const {
+        return m_data >> 12;
+    }
+
+    constexpr bool isCapture() const {
+        return (getFlags() & CAPTURE) != 0;
+    }
+
+    constexpr bool isPromotion() const {
+        return (getFlags() & KNIGHT_PROMOTION) != 0;
+    }
+
+    constexpr bool isCastle() const {
+        return getFlags() == KING_CASTLE || getFlags() == QUEEN_CASTLE;
+    }
+
+    constexpr PieceType getPromotionType() const {
+        switch (getFlags() & 3) {
+        case 0:
+            return PieceType::KNIGHT;
+        case 1:
+            return PieceType::BISHOP;
+        case 2:
+            return PieceType::ROOK;
+        default:
+            return PieceType::QUEEN;
+        }
+    }
+
+    constexpr bool isNull() const {
+        return m_data == 0;
+    }
+
+    // long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q".
+    std::string toString() const {
+        std::string text = {static_cast<char>('a' + (getFrom() & 7)), static_cast<char>('1' + (getFrom() >> 3)),
+                            static_cast<char>('a' + (getTo() & 7)), static_cast<char>('1' + (getTo() >> 3))};
+        if (isPromotion()) {
+            const char promotionChars[] = "nbrq";
+            text += promotionChars[getFlags() & 3];
+        }
+        return text;
+    }
+
+    constexpr std::uint16_t getData() const {
+        return m_data;
+    }
+
+    constexpr bool operator==(const Move& other) const {
+        return m_data == other.m_data;
+    }
+
+    constexpr bool operator!=(const Move& other) const {
+        return m_data != other.m_data;
+    }
+
+private:
+    std::uint16_t m_data;
+};
+
+// fixed-capacity move list that lives on the stack; 256 is above the 218 moves of the
+// most mobile known position.
+class MoveList {
+public:
+    static constexpr int CAPACITY = 256;
+
+    MoveList()
+        : m_size(0) {}
+
+    void push(Move move) {
+        m_moves[m_size++] = move;
+    }
+
+    void clear() {
+        m_size = 0;
+    }
+
+    int size() const {
+        return m_size;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    bool contains(Move move) const {
+        for (int i = 0; i < m_size; ++i) {
+            if (m_moves[i] == move) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Move& operator[](int index) {
+        return m_moves[index];
+    }
+
+    const Move& operator[](int index) const {
+        return m_moves[index];
+    }
+
+    Move* begin() {
+        return m_moves;
+    }
+
+    Move* end() {
+        return m_moves + m_size;
+    }
+
+    const Move* begin() const {
+        return m_moves;
+    }
+
+    const Move* end() const {
+        return m_moves + m_size;
+    }
+
+private:
+    Move m_moves[CAPACITY];
+    int m_size;
+};
+
+#endif
@@ -1,211 +1,310 @@
 #include "movelogic.hpp"
-#include "chess.hpp"
+#include "attacks.hpp"
 
-MoveLogic::MoveLogic(Chess* chess)
-    : chess(chess) {}
+void MoveLogic::generateMoves(const Board& board, PieceColour colour, MoveList& moves) {
+    Bitboard pawns = board.getPieces(colour, PieceType::PAWN);
+    addPawnMoves(board, colour, pawns, ~0ULL, moves);
+    addEnPassantMoves(board, colour, pawns, false, moves);
 
-bool MoveLogic::isWithinBounds(int row, int col) const {
-    int boardSize = chess->getBoardSize();
-    return row >= 0 && row < boardSize && col >= 0 && col < boardSize;
-}
+    Bitboard pieces = board.getOccupancy(colour) & ~pawns;
+    while (pieces) {
+        int from = popLsb(pieces);
+        addMoves(board, from, getPieceTargets(board, board.getPieceType(from), colour, from), moves);
+    }
 
-bool MoveLogic::isSquareEmpty(int row, int col) const {
-    const auto& board = chess->getBoard();
-    return board[row][col].type == PieceType::EMPTY;
+    addCastlingMoves(board, colour, moves);
 }
 
-bool MoveLogic::isOpponentPiece(int row, int col, PieceColour colour) const {
-    const auto& board = chess->getBoard();
-    return board[row][col].colour != colour && board[row][col].type != PieceType::EMPTY;
-}
+void MoveLogic::generatePieceMoves(const Board& board, int square, MoveList& moves) {
+    const Piece piece = board.getPiece(square);
 
-void MoveLogic::tryAddMove(int row, int col, std::vector<Position>& moves) const {
-    if (isWithinBounds(row, col) && isSquareEmpty(row, col)) {
-        moves.push_back({row, col});
-    }
-}
+    if (piece.type == PieceType::PAWN) {
+        addPawnMoves(board, piece.colour, squareBit(square), ~0ULL, moves);
+        addEnPassantMoves(board, piece.colour, squareBit(square), false, moves);
+    } else if (piece.active) {
+        addMoves(board, square, getPieceTargets(board, piece.type, piece.colour, square), moves);
 
-void MoveLogic::tryAddCaptureMove(int row, int col, PieceColour colour, std::vector<Position>& moves) const {
-    if (isWithinBounds(row, col) && isOpponentPiece(row, col, colour)) {
-        moves.push_back({row, col});
+        if (piece.type == PieceType::KING) {
+            addCastlingMoves(board, piece.colour, moves);
+        }
     }
 }
 
-std::vector<Position> MoveLogic::processPieceMoves(const Piece& piece, int row, int col) {
-    std::vector<Position> moves;
+void MoveLogic::generateLegalMoves(const Board& board, MoveList& moves, MoveGenType type) {
+    const PieceColour us = board.getSideToMove();
+    const PieceColour them = oppositeColour(us);
+    const int king = board.findKing(us);
+    const Bitboard occupied = board.getOccupancy();
+    const Bitboard ours = board.getOccupancy(us);
+    const Bitboard enemies = board.getOccupancy(them);
+
+    const Bitboard checkers = board.getCheckers();
+
+    // non-pawn pieces only need their targets restricted to enemy or empty squares.
+    const Bitboard typeMask = type == MoveGenType::CAPTURES ? enemies : type == MoveGenType::QUIETS ? ~occupied : ~0ULL;
+
+    // king targets are tested with the king lifted off the board, otherwise it could
+    // step backwards along the ray of the slider checking it.
+    Bitboard kingTargets = getKingAttacks(king) & ~ours & typeMask;
+    while (kingTargets) {
+        int to = popLsb(kingTargets);
+        if (!(board.getAttackersTo(to, occupied ^ squareBit(king)) & enemies)) {
+            moves.push(Move(king, to, (enemies & squareBit(to)) ? CAPTURE : QUIET_MOVE));
+        }
+    }
 
-    switch (piece.type) {
-    case PieceType::PAWN:
-        moves = getPawnMoves(piece, row, col);
-        break;
-    case PieceType::KNIGHT:
-        moves = getKnightMoves(piece, row, col);
-        break;
-    case PieceType::BISHOP:
-        moves = getBishopMoves(piece, row, col);
-        break;
-    case PieceType::ROOK:
-        moves = getRookMoves(piece, row, col);
-        break;
-    case PieceType::QUEEN:
-        moves = getQueenMoves(piece, row, col);
-        break;
-    case PieceType::KING:
-        moves = getKingMoves(piece, row, col);
-        break;
+    if (moreThanOne(checkers)) {
+        return;
     }
 
-    return moves;
-}
+    if (!checkers && type != MoveGenType::CAPTURES) {
+        addCastlingMoves(board, us, moves);
+    }
 
-std::vector<Position> MoveLogic::getPawnMoves(const Piece& pawn, int row, int col) {
-    std::vector<Position> moves;
+    // in check every other move must capture the checker or block its ray.
+    const Bitboard evasionMask = checkers ? (getBetween(king, lsb(checkers)) | checkers) : ~0ULL;
+    const Bitboard pinned = getPinnedPieces(board, us, king);
 
-    int direction = (pawn.colour == PieceColour::WHITE) ? -1 : 1;
-    int startRow = (pawn.colour == PieceColour::WHITE) ? 6  // white pawn start row
-                                                       : 1; // black pawn start row
+    Bitboard pawns = board.getPieces(us, PieceType::PAWN);
+    addPawnMoves(board, us, pawns & ~pinned, evasionMask, moves, type);
 
-    tryAddMove(row + direction, col, moves);
+    Bitboard pinnedPawns = pawns & pinned;
+    while (pinnedPawns) {
+        int from = popLsb(pinnedPawns);
+        addPawnMoves(board, us, squareBit(from), evasionMask & getLine(king, from), moves, type);
+    }
 
-    if (row == startRow) {
-        int doubleRow = row + 2 * direction;
-        if (isSquareEmpty(row + direction, col)) {
-            tryAddMove(doubleRow, col, moves);
-        }
+    if (type != MoveGenType::QUIETS) {
+        addEnPassantMoves(board, us, pawns, true, moves);
     }
 
-    tryAddCaptureMove(row + direction, col - 1, pawn.colour, moves);
-    tryAddCaptureMove(row + direction, col + 1, pawn.colour, moves);
+    Bitboard pieces = ours & ~pawns & ~squareBit(king);
+    while (pieces) {
+        int from = popLsb(pieces);
+        Bitboard targets = getPieceTargets(board, board.getPieceType(from), us, from) & evasionMask & typeMask;
 
-    return moves;
+        if (pinned & squareBit(from)) {
+            targets &= getLine(king, from);
+        }
+
+        addMoves(board, from, targets, moves);
+    }
 }
 
-std::vector<Position> MoveLogic::getKnightMoves(const Piece& knight, int row, int col) {
-    std::vector<Position> moves;
+bool MoveLogic::isLegalMove(const Board& board, Move move) {
+    const PieceColour us = board.getSideToMove();
+    const int from = move.getFrom();
+    const int to = move.getTo();
 
-    const std::vector<std::pair<int, int>> knightMoveOffsets = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-                                                                {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+    if (move.isNull() || !(board.getOccupancy(us) & squareBit(from))) {
+        return false;
+    }
 
-    for (const auto& offset : knightMoveOffsets) {
-        int newRow = row + offset.first;
-        int newCol = col + offset.second;
+    // the piece's own pseudo-legal moves carry the exact flags, which rules out stale
+    // captures, promotions and castles in one comparison.
+    MoveList pieceMoves;
+    generatePieceMoves(board, from, pieceMoves);
+    if (!pieceMoves.contains(move)) {
+        return false;
+    }
 
-        if (isWithinBounds(newRow, newCol)) {
-            if (isSquareEmpty(newRow, newCol) || isOpponentPiece(newRow, newCol, knight.colour)) {
-                moves.push_back({newRow, newCol});
-            }
-        }
+    const int king = board.findKing(us);
+    const Bitboard enemies = board.getOccupancy(oppositeColour(us));
+
+    // castling was fully checked by the generator.
+    if (move.isCastle()) {
+        return true;
     }
 
-    return moves;
-}
+    if (from == king) {
+        return !(board.getAttackersTo(to, board.getOccupancy() ^ squareBit(king)) & enemies);
+    }
 
-std::vector<Position> MoveLogic::getBishopMoves(const Piece& bishop, int row, int col) {
-    std::vector<Position> moves;
+    if (move.getFlags() == EN_PASSANT) {
+        const int victim = to + (us == PieceColour::WHITE ? -8 : 8);
+        Bitboard occupied = board.getOccupancy() ^ squareBit(from) ^ squareBit(victim) ^ squareBit(to);
+        return !(board.getAttackersTo(king, occupied) & enemies & ~squareBit(victim));
+    }
 
-    const std::vector<std::pair<int, int>> bishopDirections = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+    const Bitboard checkers = board.getCheckers();
+    if (moreThanOne(checkers)) {
+        return false;
+    }
+    if (checkers && !((getBetween(king, lsb(checkers)) | checkers) & squareBit(to))) {
+        return false;
+    }
 
-    for (const auto& direction : bishopDirections) {
-        int newRow = row;
-        int newCol = col;
+    return !(getPinnedPieces(board, us, king) & squareBit(from)) || (getLine(king, from) & squareBit(to));
+}
 
-        while (true) {
-            newRow += direction.first;
-            newCol += direction.second;
+Bitboard MoveLogic::getPinnedPieces(const Board& board, PieceColour colour, int kingSquare) {
+    const PieceColour them = oppositeColour(colour);
+    const Bitboard queens = board.getPieces(them, PieceType::QUEEN);
+    const Bitboard occupied = board.getOccupancy();
 
-            if (!isWithinBounds(newRow, newCol)) {
-                break;
-            }
+    Bitboard snipers = (getRookAttacks(kingSquare, 0) & (board.getPieces(them, PieceType::ROOK) | queens)) |
+                       (getBishopAttacks(kingSquare, 0) & (board.getPieces(them, PieceType::BISHOP) | queens));
+    Bitboard pinned = 0;
 
-            if (isSquareEmpty(newRow, newCol)) {
-                moves.push_back({newRow, newCol});
-            } else if (isOpponentPiece(newRow, newCol, bishop.colour)) {
-                moves.push_back({newRow, newCol});
-                break;
-            } else {
-                break;
-            }
+    while (snipers) {
+        Bitboard blockers = getBetween(kingSquare, popLsb(snipers)) & occupied;
+        if (blockers && !moreThanOne(blockers)) {
+            pinned |= blockers & board.getOccupancy(colour);
         }
     }
 
-    return moves;
+    return pinned;
 }
 
-std::vector<Position> MoveLogic::getRookMoves(const Piece& rook, int row, int col) {
-    std::vector<Position> moves;
-
-    const std::vector<std::pair<int, int>> directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+Bitboard MoveLogic::getPieceTargets(const Board& board, PieceType type, PieceColour colour, int square) {
+    Bitboard occupied = board.getOccupancy();
+    Bitboard attacks = 0;
 
-    for (const auto& direction : directions) {
-        int newRow = row;
-        int newCol = col;
-
-        while (true) {
-            newRow += direction.first;
-            newCol += direction.second;
+    switch (type) {
+    case PieceType::KNIGHT:
+        attacks = getKnightAttacks(square);
+        break;
+    case PieceType::BISHOP:
+        attacks = getBishopAttacks(square, occupied);
+        break;
+    case PieceType::ROOK:
+        attacks = getRookAttacks(square, occupied);
+        break;
+    case PieceType::QUEEN:
+        attacks = getQueenAttacks(square, occupied);
+        break;
+    case PieceType::KING:
+        attacks = getKingAttacks(square);
+        break;
+    default:
+        break;
+    }
 
-            if (!isWithinBounds(newRow, newCol)) {
-                break;
-            }
+    return attacks & ~board.getOccupancy(colour);
+}
 
-            if (isSquareEmpty(newRow, newCol)) {
-                moves.push_back({newRow, newCol});
-            } else if (isOpponentPiece(newRow, newCol, rook.colour)) {
-                moves.push_back({newRow, newCol});
-                break;
-            } else {
-                break;
-            }
-        }
+void MoveLogic::addMoves(const Board& board, int from, Bitboard targets, MoveList& moves) {
+    while (targets) {
+        int to = popLsb(targets);
+        moves.push(Move(from, to, board.isSquareEmpty(to) ? QUIET_MOVE : CAPTURE));
     }
-
-    return moves;
 }
 
-std::vector<Position> MoveLogic::getQueenMoves(const Piece& queen, int row, int col) {
-    std::vector<Position> moves;
+void MoveLogic::addPawnMoves(const Board& board, PieceColour colour, Bitboard pawns, Bitboard targetMask, MoveList& moves,
+                             MoveGenType type) {
+    const bool white = colour == PieceColour::WHITE;
+    const int forward = white ? 8 : -8;
+    const Bitboard empty = ~board.getOccupancy();
+    const Bitboard enemies = board.getOccupancy(oppositeColour(colour));
+    const Bitboard promotionRank = white ? RANK_8 : RANK_1;
+
+    Bitboard single = (white ? shiftNorth(pawns) : shiftSouth(pawns)) & empty;
+    Bitboard doubles = (white ? shiftNorth(single & RANK_3) : shiftSouth(single & RANK_6)) & empty;
+
+    single &= targetMask;
+    doubles &= targetMask;
+
+    if (type != MoveGenType::CAPTURES) {
+        Bitboard pushes = single & ~promotionRank;
+        while (pushes) {
+            int to = popLsb(pushes);
+            moves.push(Move(to - forward, to));
+        }
 
-    const std::vector<std::pair<int, int>> directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+        while (doubles) {
+            int to = popLsb(doubles);
+            moves.push(Move(to - 2 * forward, to, DOUBLE_PAWN_PUSH));
+        }
+    }
 
-    for (const auto& direction : directions) {
-        int newRow = row;
-        int newCol = col;
+    if (type == MoveGenType::QUIETS) {
+        return;
+    }
 
-        while (true) {
-            newRow += direction.first;
-            newCol += direction.second;
+    Bitboard promotions = single & promotionRank;
+    while (promotions) {
+        int to = popLsb(promotions);
+        addPromotions(to - forward, to, false, moves);
+    }
 
-            if (!isWithinBounds(newRow, newCol)) {
-                break;
-            }
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard captures = getPawnAttacks(colour, from) & enemies & targetMask;
 
-            if (isSquareEmpty(newRow, newCol)) {
-                moves.push_back({newRow, newCol});
-            } else if (isOpponentPiece(newRow, newCol, queen.colour)) {
-                moves.push_back({newRow, newCol});
-                break;
+        while (captures) {
+            int to = popLsb(captures);
+            if (squareBit(to) & promotionRank) {
+                addPromotions(from, to, true, moves);
             } else {
-                break;
+                moves.push(Move(from, to, CAPTURE));
             }
         }
     }
+}
 
-    return moves;
+void MoveLogic::addPromotions(int from, int to, bool capture, MoveList& moves) {
+    moves.push(Move(from, to, promotionFlag(PieceType::QUEEN, capture)));
+    moves.push(Move(from, to, promotionFlag(PieceType::KNIGHT, capture)));
+    moves.push(Move(from, to, promotionFlag(PieceType::ROOK, capture)));
+    moves.push(Move(from, to, promotionFlag(PieceType::BISHOP, capture)));
 }
 
-std::vector<Position> MoveLogic::getKingMoves(const Piece& king, int row, int col) {
-    std::vector<Position> moves;
+void MoveLogic::addEnPassantMoves(const Board& board, PieceColour colour, Bitboard pawns, bool legalOnly, MoveList& moves) {
+    const int target = board.getEnPassantSquare();
+    if (target == NO_SQUARE || colour != board.getSideToMove()) {
+        return;
+    }
+
+    const int victim = target + (colour == PieceColour::WHITE ? -8 : 8);
+    const int king = board.findKing(colour);
+    const Bitboard enemies = board.getOccupancy(oppositeColour(colour));
+
+    Bitboard attackers = pawns & getPawnAttacks(oppositeColour(colour), target);
+    while (attackers) {
+        int from = popLsb(attackers);
 
-    for (int r = row - 1; r <= row + 1; ++r) {
-        for (int c = col - 1; c <= col + 1; ++c) {
-            if ((r == row && c == col) || !isWithinBounds(r, c)) {
+        // two pawns leave the board's occupancy at once, which neither the pin mask nor
+        // the evasion mask can express (e.g. a rook behind both pawns on the fifth rank),
+        // so replay the occupancy change and ask the king directly.
+        if (legalOnly) {
+            Bitboard occupied = board.getOccupancy() ^ squareBit(from) ^ squareBit(victim) ^ squareBit(target);
+            if (board.getAttackersTo(king, occupied) & enemies & ~squareBit(victim)) {
                 continue;
             }
-            if (isSquareEmpty(r, c) || isOpponentPiece(r, c, king.colour)) {
-                moves.push_back({r, c});
-            }
         }
+
+        moves.push(Move(from, target, EN_PASSANT));
     }
+}
+
+void MoveLogic::addCastlingMoves(const Board& board, PieceColour colour, MoveList& moves) {
+    const bool white = colour == PieceColour::WHITE;
+    const std::uint8_t rights = board.getCastlingRights() & (white ? WHITE_KING_SIDE | WHITE_QUEEN_SIDE : BLACK_KING_SIDE | BLACK_QUEEN_SIDE);
+
+    if (!rights || colour != board.getSideToMove() || board.getCheckers()) {
+        return;
+    }
+
+    // rights are dropped when the king leaves its square, but a hand-built position may not
+    // have it there.
+    const int king = white ? 4 : 60;
+    if (!(board.getPieces(colour, PieceType::KING) & squareBit(king))) {
+        return;
+    }
+
+    const PieceColour them = oppositeColour(colour);
+    const Bitboard occupied = board.getOccupancy();
+    const Bitboard rooks = board.getPieces(colour, PieceType::ROOK);
 
-    return moves;
+    if ((rights & (WHITE_KING_SIDE | BLACK_KING_SIDE)) && (rooks & squareBit(king + 3)) &&
+        !(occupied & (squareBit(king + 1) | squareBit(king + 2))) && !board.isSquareAttacked(king + 1, them) &&
+        !board.isSquareAttacked(king + 2, them)) {
+        moves.push(Move(king, king + 2, KING_CASTLE));
+    }
+
+    if ((rights & (WHITE_QUEEN_SIDE | BLACK_QUEEN_SIDE)) && (rooks & squareBit(king - 4)) &&
+        !(occupied & (squareBit(king - 1) | squareBit(king - 2) | squareBit(king - 3))) &&
+        !board.isSquareAttacked(king - 1, them) && !board.isSquareAttacked(king - 2, them)) {
+        moves.push(Move(king, king - 2, QUEEN_CASTLE));
+    }
 }
@@ -1,31 +1,44 @@
 #ifndef MOVELOGIC_HPP
 #define MOVELOGIC_HPP
 
-#include <vector>
+#include "bitboard.hpp"
+#include "board.hpp"
+#include "move.hpp"
 
-#include "piece.hpp"
+// which part of the legal moves to generate. CAPTURES and QUIETS partition ALL: captures,
+// en passant and every promotion are "captures", everything else (castling included) quiet,
+// so a search can stop after the captures without generating the rest.
+enum class MoveGenType {
+    ALL,
+    CAPTURES,
+    QUIETS,
+};
 
+// move generation straight from the bitboards into a caller-owned MoveList; nothing here
+// touches the heap.
 class MoveLogic {
 public:
-    explicit MoveLogic(class Chess* chess);
-    std::vector<struct Position> processPieceMoves(const Piece& piece, int row, int col);
+    // pseudo-legal moves: may leave the mover's own king in check.
+    static void generateMoves(const Board& board, PieceColour colour, MoveList& moves);
+    static void generatePieceMoves(const Board& board, int square, MoveList& moves);
 
-private:
-    Chess* chess;
+    // fully legal moves for the side to move. checkers and pinned pieces are worked out
+    // once up front, so no move has to be made to test it.
+    static void generateLegalMoves(const Board& board, MoveList& moves, MoveGenType type = MoveGenType::ALL);
+    static Bitboard getPinnedPieces(const Board& board, PieceColour colour, int kingSquare);
 
-private:
-    bool isWithinBounds(int row, int col) const;
-    bool isSquareEmpty(int row, int col) const;
-    bool isOpponentPiece(int row, int col, PieceColour colour) const;
-    void tryAddMove(int row, int col, std::vector<struct Position>& moves) const;
-    void tryAddCaptureMove(int row, int col, PieceColour colour, std::vector<struct Position>& moves) const;
+    // whether a move from elsewhere (hash table, killer slots) is legal in this position,
+    // without generating the whole move list.
+    static bool isLegalMove(const Board& board, Move move);
 
-    std::vector<struct Position> getPawnMoves(const Piece& pawn, int row, int col);
-    std::vector<struct Position> getKnightMoves(const Piece& knight, int row, int col);
-    std::vector<struct Position> getBishopMoves(const Piece& bishop, int row, int col);
-    std::vector<struct Position> getRookMoves(const Piece& rook, int row, int col);
-    std::vector<struct Position> getQueenMoves(const Piece& queen, int row, int col);
-    std::vector<struct Position> getKingMoves(const Piece& king, int row, int col);
+private:
+    static void addMoves(const Board& board, int from, Bitboard targets, MoveList& moves);
+    static void addPawnMoves(const Board& board, PieceColour colour, Bitboard pawns, Bitboard targetMask, MoveList& moves,
+                             MoveGenType type = MoveGenType::ALL);
+    static void addPromotions(int from, int to, bool capture, MoveList& moves);
+    static void addEnPassantMoves(const Board& board, PieceColour colour, Bitboard pawns, bool legalOnly, MoveList& moves);
+    static void addCastlingMoves(const Board& board, PieceColour colour, MoveList& moves);
+    static Bitboard getPieceTargets(const Board& board, PieceType type, PieceColour colour, int square);
 };
 
 #endif
@@ -0,0 +1,168 @@
+#include "movepicker.hpp"
+#include "evaluate.hpp"
+#include "see.hpp"
+
+#include <utility>
+
+MovePicker::MovePicker(const Board& board, Move ttMove, const Move (&killers)[2], Move counterMove,
+                       const HistoryTable& history)
+    : m_board(board)
+    , m_history(history)
+    , m_stage(PickerStage::TT_MOVE)
+    , m_ttMove(ttMove)
+    , m_killers{killers[0], killers[1]}
+    , m_counterMove(counterMove)
+    , m_index(0)
+    , m_badCaptureIndex(0) {}
+
+MovePicker::MovePicker(const Board& board, const HistoryTable& history)
+    : m_board(board)
+    , m_history(history)
+    , m_stage(board.getCheckers() ? PickerStage::GENERATE_CAPTURES : PickerStage::QS_GENERATE_CAPTURES)
+    , m_index(0)
+    , m_badCaptureIndex(0) {}
+
+Move MovePicker::next() {
+    while (true) {
+        switch (m_stage) {
+        case PickerStage::TT_MOVE:
+            m_stage = PickerStage::GENERATE_CAPTURES;
+            if (MoveLogic::isLegalMove(m_board, m_ttMove)) {
+                return m_ttMove;
+            }
+            break;
+
+        case PickerStage::GENERATE_CAPTURES:
+        case PickerStage::QS_GENERATE_CAPTURES:
+            m_moves.clear();
+            MoveLogic::generateLegalMoves(m_board, m_moves, MoveGenType::CAPTURES);
+            scoreCaptures();
+            m_index = 0;
+            m_stage = m_stage == PickerStage::GENERATE_CAPTURES ? PickerStage::CAPTURES : PickerStage::QS_CAPTURES;
+            break;
+
+        case PickerStage::CAPTURES:
+            // exchanges are only evaluated for captures actually reached, and losing ones
+            // wait until after the quiets.
+            while (m_index < m_moves.size()) {
+                Move move = pickBest();
+                if (move == m_ttMove) {
+                    continue;
+                }
+                if (staticExchange(m_board, move) < 0) {
+                    m_badCaptures.push(move);
+                    continue;
+                }
+                return move;
+            }
+            m_stage = PickerStage::KILLER_1;
+            break;
+
+        case PickerStage::KILLER_1:
+        case PickerStage::KILLER_2: {
+            Move killer = m_killers[m_stage == PickerStage::KILLER_1 ? 0 : 1];
+            m_stage = m_stage == PickerStage::KILLER_1 ? PickerStage::KILLER_2 : PickerStage::COUNTER_MOVE;
+            if (killer != m_ttMove && isUsable(killer)) {
+                return killer;
+            }
+            break;
+        }
+
+        case PickerStage::COUNTER_MOVE:
+            m_stage = PickerStage::GENERATE_QUIETS;
+            if (m_counterMove != m_ttMove && m_counterMove != m_killers[0] && m_counterMove != m_killers[1] &&
+                isUsable(m_counterMove)) {
+                return m_counterMove;
+            }
+            break;
+
+        case PickerStage::GENERATE_QUIETS:
+            m_moves.clear();
+            MoveLogic::generateLegalMoves(m_board, m_moves, MoveGenType::QUIETS);
+            scoreQuiets();
+            m_index = 0;
+            m_stage = PickerStage::QUIETS;
+            break;
+
+        case PickerStage::QUIETS:
+            while (m_index < m_moves.size()) {
+                Move move = pickBest();
+                if (!isSpecialMove(move)) {
+                    return move;
+                }
+            }
+            m_stage = PickerStage::BAD_CAPTURES;
+            break;
+
+        case PickerStage::BAD_CAPTURES:
+            if (m_badCaptureIndex < m_badCaptures.size()) {
+                return m_badCaptures[m_badCaptureIndex++];
+            }
+            m_stage = PickerStage::DONE;
+            break;
+
+        case PickerStage::QS_CAPTURES:
+            while (m_index < m_moves.size()) {
+                Move move = pickBest();
+                // underpromotions without a capture do not change the material balance enough to
+                // matter here, and a capture that loses the exchange cannot raise the score.
+                if ((move.isCapture() || move.getFlags() == QUEEN_PROMOTION) && staticExchange(m_board, move) >= 0) {
+                    return move;
+                }
+            }
+            m_stage = PickerStage::DONE;
+            break;
+
+        case PickerStage::DONE:
+            return Move();
+        }
+    }
+}
+
+void MovePicker::scoreCaptures() {
+    for (int i = 0; i < m_moves.size(); ++i) {
+        const Move move = m_moves[i];
+        int score = 0;
+
+        // most valuable victim first, least valuable attacker breaking ties.
+        if (move.isCapture()) {
+            PieceType victim = move.getFlags() == EN_PASSANT ? PieceType::PAWN : m_board.getPieceType(move.getTo());
+            score = getPieceValue(victim) * 8 - getPieceValue(m_board.getPieceType(move.getFrom())) / 8;
+        }
+        if (move.isPromotion()) {
+            score += getPieceValue(move.getPromotionType());
+        }
+
+        m_scores[i] = score;
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    const int side = colourIndex(m_board.getSideToMove());
+    for (int i = 0; i < m_moves.size(); ++i) {
+        m_scores[i] = m_history[side][m_moves[i].getFrom()][m_moves[i].getTo()];
+    }
+}
+
+// one step of a selection sort: only as much of the list is ordered as is consumed.
+Move MovePicker::pickBest() {
+    int best = m_index;
+    for (int i = m_index + 1; i < m_moves.size(); ++i) {
+        if (m_scores[i] > m_scores[best]) {
+            best = i;
+        }
+    }
+
+    std::swap(m_moves[m_index], m_moves[best]);
+    std::swap(m_scores[m_index], m_scores[best]);
+    return m_moves[m_index++];
+}
+
+bool MovePicker::isSpecialMove(Move move) const {
+    return move == m_ttMove || move == m_killers[0] || move == m_killers[1] || move == m_counterMove;
+}
+
+// killers and countermoves come from other positions, so they must be quiet and legal here.
+bool MovePicker::isUsable(Move move) const {
+    return !move.isNull() && !move.isCapture() && !move.isPromotion() && MoveLogic::isLegalMove(m_board, move);
+}
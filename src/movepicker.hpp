@@ -0,0 +1,73 @@
+#ifndef MOVEPICKER_HPP
+#define MOVEPICKER_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+#include "movelogic.hpp"
+
+// quiet-move history, indexed by side to move, from square and to square.
+using HistoryTable = int[2][64][64];
+
+constexpr int MAX_HISTORY = 16384;
+
+enum class PickerStage {
+    TT_MOVE,
+    GENERATE_CAPTURES,
+    CAPTURES,
+    KILLER_1,
+    KILLER_2,
+    COUNTER_MOVE,
+    GENERATE_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    QS_GENERATE_CAPTURES,
+    QS_CAPTURES,
+    DONE,
+};
+
+// hands out legal moves best-first, one stage at a time: the hash move, captures by
+// MVV-LVA, the two killers and the countermove, the remaining quiets by history, and last
+// the captures that static exchange evaluation says lose material.
+// every stage is generated and scored only when the previous one runs out, and picked
+// with a selection sort over what is left, so a cutoff on an early move skips the rest.
+class MovePicker {
+public:
+    // main search.
+    MovePicker(const Board& board, Move ttMove, const Move (&killers)[2], Move counterMove, const HistoryTable& history);
+
+    // quiescence search: captures and queen promotions that do not lose material, or every
+    // evasion when in check.
+    MovePicker(const Board& board, const HistoryTable& history);
+
+    // returns a null move once every stage is exhausted.
+    Move next();
+
+    PickerStage getStage() const {
+        return m_stage;
+    }
+
+private:
+    void scoreCaptures();
+    void scoreQuiets();
+    Move pickBest();
+    bool isSpecialMove(Move move) const;
+    bool isUsable(Move move) const;
+
+private:
+    const Board& m_board;
+    const HistoryTable& m_history;
+
+    PickerStage m_stage;
+    Move m_ttMove;
+    Move m_killers[2];
+    Move m_counterMove;
+
+    MoveList m_moves;
+    int m_scores[MoveList::CAPACITY];
+    int m_index;
+
+    MoveList m_badCaptures;
+    int m_badCaptureIndex;
+};
+
+#endif
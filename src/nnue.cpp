@@ -0,0 +1,477 @@
+#include "nnue.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(_WIN32)
+#    define NNUE_NO_MMAP
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define NNUE_X86
+#    include <immintrin.h>
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#        define NNUE_TARGET(isa)
+#    else
+#        define NNUE_TARGET(isa) __attribute__((target(isa)))
+#    endif
+#endif
+
+namespace {
+
+constexpr int CLIP_MAX = 127;
+
+using UpdateKernel = void (*)(const std::int16_t*, std::int16_t*, const std::int8_t* const*, int, const std::int8_t* const*,
+                              int);
+using OutputKernel = std::int32_t (*)(const std::int16_t*, const std::int16_t*, const std::int8_t*);
+
+void updateScalar(const std::int16_t* src, std::int16_t* dst, const std::int8_t* const* added, int addedCount,
+                  const std::int8_t* const* removed, int removedCount) {
+    std::int16_t values[NNUE_HIDDEN];
+    std::copy(src, src + NNUE_HIDDEN, values);
+    for (int a = 0; a < addedCount; ++a) {
+        for (int i = 0; i < NNUE_HIDDEN; ++i) {
+            values[i] = static_cast<std::int16_t>(values[i] + added[a][i]);
+        }
+    }
+    for (int r = 0; r < removedCount; ++r) {
+        for (int i = 0; i < NNUE_HIDDEN; ++i) {
+            values[i] = static_cast<std::int16_t>(values[i] - removed[r][i]);
+        }
+    }
+    std::copy(values, values + NNUE_HIDDEN, dst);
+}
+
+std::int32_t outputScalar(const std::int16_t* us, const std::int16_t* them, const std::int8_t* weights) {
+    std::int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        sum += std::clamp<int>(us[i], 0, CLIP_MAX) * weights[i];
+        sum += std::clamp<int>(them[i], 0, CLIP_MAX) * weights[NNUE_HIDDEN + i];
+    }
+    return sum;
+}
+
+#if defined(NNUE_X86)
+
+NNUE_TARGET("sse4.1")
+void updateSse41(const std::int16_t* src, std::int16_t* dst, const std::int8_t* const* added, int addedCount,
+                 const std::int8_t* const* removed, int removedCount) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        for (int a = 0; a < addedCount; ++a) {
+            __m128i weights = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(added[a] + i));
+            value = _mm_add_epi16(value, _mm_cvtepi8_epi16(weights));
+        }
+        for (int r = 0; r < removedCount; ++r) {
+            __m128i weights = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(removed[r] + i));
+            value = _mm_sub_epi16(value, _mm_cvtepi8_epi16(weights));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+}
+
+NNUE_TARGET("sse4.1")
+std::int32_t outputSse41(const std::int16_t* us, const std::int16_t* them, const std::int8_t* weights) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i clipMax = _mm_set1_epi16(CLIP_MAX);
+    __m128i sum = _mm_setzero_si128();
+
+    for (int half = 0; half < 2; ++half) {
+        const std::int16_t* values = half == 0 ? us : them;
+        const std::int8_t* halfWeights = weights + half * NNUE_HIDDEN;
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            value = _mm_min_epi16(_mm_max_epi16(value, zero), clipMax);
+            __m128i weight = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(halfWeights + i)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(value, weight));
+        }
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+NNUE_TARGET("avx2")
+void updateAvx2(const std::int16_t* src, std::int16_t* dst, const std::int8_t* const* added, int addedCount,
+                const std::int8_t* const* removed, int removedCount) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        for (int a = 0; a < addedCount; ++a) {
+            __m128i weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(added[a] + i));
+            value = _mm256_add_epi16(value, _mm256_cvtepi8_epi16(weights));
+        }
+        for (int r = 0; r < removedCount; ++r) {
+            __m128i weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(removed[r] + i));
+            value = _mm256_sub_epi16(value, _mm256_cvtepi8_epi16(weights));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+}
+
+NNUE_TARGET("avx2")
+std::int32_t outputAvx2(const std::int16_t* us, const std::int16_t* them, const std::int8_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i clipMax = _mm256_set1_epi16(CLIP_MAX);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (int half = 0; half < 2; ++half) {
+        const std::int16_t* values = half == 0 ? us : them;
+        const std::int8_t* halfWeights = weights + half * NNUE_HIDDEN;
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            value = _mm256_min_epi16(_mm256_max_epi16(value, zero), clipMax);
+            __m256i weight = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(halfWeights + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(value, weight));
+        }
+    }
+
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+    return _mm_cvtsi128_si32(total);
+}
+
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(NNUE_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::SSE41;
+    }
+#elif defined(NNUE_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    if (osSavesAvx && (info[1] & (1 << 5)) != 0) {
+        return SimdLevel::AVX2;
+    }
+    if (sse41) {
+        return SimdLevel::SSE41;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+const SimdLevel supportedSimdLevel = detectSimdLevel();
+SimdLevel activeSimdLevel = supportedSimdLevel;
+UpdateKernel updateKernel = updateScalar;
+OutputKernel outputKernel = outputScalar;
+
+void selectKernels(SimdLevel level) {
+    activeSimdLevel = level;
+    updateKernel = updateScalar;
+    outputKernel = outputScalar;
+#if defined(NNUE_X86)
+    if (level == SimdLevel::AVX2) {
+        updateKernel = updateAvx2;
+        outputKernel = outputAvx2;
+    } else if (level == SimdLevel::SSE41) {
+        updateKernel = updateSse41;
+        outputKernel = outputSse41;
+    }
+#endif
+}
+
+struct KernelInitializer {
+    KernelInitializer() {
+        selectKernels(supportedSimdLevel);
+    }
+};
+
+const KernelInitializer kernelInitializer;
+
+constexpr std::size_t getNetworkFileSize() {
+    return sizeof(NnueHeader) + NNUE_HIDDEN * sizeof(std::int16_t) + static_cast<std::size_t>(NNUE_INPUTS) * NNUE_HIDDEN +
+           2 * NNUE_HIDDEN + sizeof(std::int32_t);
+}
+
+} // namespace
+
+SimdLevel getSupportedSimdLevel() {
+    return supportedSimdLevel;
+}
+
+SimdLevel getSimdLevel() {
+    return activeSimdLevel;
+}
+
+void setSimdLevel(SimdLevel level) {
+    selectKernels(std::min(level, supportedSimdLevel));
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
+
+NnueNetwork::~NnueNetwork() {
+    unload();
+}
+
+bool NnueNetwork::load(const std::string& path) {
+    unload();
+
+    const char* data = nullptr;
+    std::size_t size = 0;
+
+#if defined(NNUE_NO_MMAP)
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error: Could not open network file " << path << std::endl;
+        return false;
+    }
+    m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    data = m_buffer.data();
+    size = m_buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open network file " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        size = static_cast<std::size_t>(info.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            m_mapping = mapping;
+            m_mappingSize = size;
+            data = static_cast<const char*>(mapping);
+        }
+    }
+    close(fd);
+
+    if (data == nullptr) {
+        std::cerr << "Error: Could not map network file " << path << std::endl;
+        return false;
+    }
+#endif
+
+    NnueHeader header;
+    if (size != getNetworkFileSize()) {
+        std::cerr << "Error: " << path << " is " << size << " bytes, expected " << getNetworkFileSize() << std::endl;
+        unload();
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC)) != 0 || header.version != NNUE_VERSION ||
+        header.inputs != NNUE_INPUTS || header.hidden != NNUE_HIDDEN) {
+        std::cerr << "Error: " << path << " is not a compatible network file" << std::endl;
+        unload();
+        return false;
+    }
+
+    const char* cursor = data + sizeof(NnueHeader);
+    m_featureBiases = reinterpret_cast<const std::int16_t*>(cursor);
+    cursor += NNUE_HIDDEN * sizeof(std::int16_t);
+    m_featureWeights = reinterpret_cast<const std::int8_t*>(cursor);
+    cursor += static_cast<std::size_t>(NNUE_INPUTS) * NNUE_HIDDEN;
+    m_outputWeights = reinterpret_cast<const std::int8_t*>(cursor);
+    cursor += 2 * NNUE_HIDDEN;
+    std::memcpy(&m_outputBias, cursor, sizeof(m_outputBias));
+    m_outputScale = header.outputScale;
+    m_path = path;
+    return true;
+}
+
+void NnueNetwork::unload() {
+#if !defined(NNUE_NO_MMAP)
+    if (m_mapping != nullptr) {
+        munmap(m_mapping, m_mappingSize);
+    }
+#endif
+    m_mapping = nullptr;
+    m_mappingSize = 0;
+    m_buffer.clear();
+    m_featureBiases = nullptr;
+    m_featureWeights = nullptr;
+    m_outputWeights = nullptr;
+    m_outputBias = 0;
+    m_outputScale = 0;
+    m_path.clear();
+}
+
+int NnueNetwork::getKingBucket(int perspective, int kingSquare) {
+    int relative = perspective == 0 ? kingSquare : kingSquare ^ 56;
+    return (squareRank(relative) > 1 ? 2 : 0) + (squareCol(relative) > 3 ? 1 : 0);
+}
+
+int NnueNetwork::getFeatureIndex(int perspective, int kingSquare, std::uint8_t pieceCode, int square) {
+    int relativeColour = (pieceCode >> 3) == perspective ? 0 : 1;
+    int relativeSquare = perspective == 0 ? square : square ^ 56;
+    return getKingBucket(perspective, kingSquare) * 768 + (relativeColour * 6 + (pieceCode & 7) - 1) * 64 + relativeSquare;
+}
+
+void NnueNetwork::refresh(const Board& board, int perspective, std::int16_t* values) const {
+    const int kingSquare = board.findKing(colourFromIndex(perspective));
+
+    int features[32];
+    int count = 0;
+    Bitboard occupied = board.getOccupancy();
+    while (occupied && count < 32) {
+        int square = popLsb(occupied);
+        features[count++] = getFeatureIndex(perspective, kingSquare, board.getPieceCode(square), square);
+    }
+
+    update(m_featureBiases, values, features, count, nullptr, 0);
+}
+
+void NnueNetwork::update(const std::int16_t* src, std::int16_t* dst, const int* added, int addedCount, const int* removed,
+                         int removedCount) const {
+    // at most 32 features at once, so the row pointers fit on the stack.
+    const std::int8_t* addedRows[32];
+    const std::int8_t* removedRows[32];
+    for (int i = 0; i < addedCount; ++i) {
+        addedRows[i] = m_featureWeights + static_cast<std::size_t>(added[i]) * NNUE_HIDDEN;
+    }
+    for (int i = 0; i < removedCount; ++i) {
+        removedRows[i] = m_featureWeights + static_cast<std::size_t>(removed[i]) * NNUE_HIDDEN;
+    }
+    updateKernel(src, dst, addedRows, addedCount, removedRows, removedCount);
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, PieceColour sideToMove) const {
+    int us = colourIndex(sideToMove);
+    std::int64_t sum = outputKernel(accumulator.values[us], accumulator.values[us ^ 1], m_outputWeights);
+    return static_cast<int>((sum + m_outputBias) * m_outputScale / NNUE_WEIGHT_SCALE);
+}
+
+int NnueNetwork::evaluate(const Board& board) const {
+    NnueAccumulator accumulator;
+    refresh(board, 0, accumulator.values[0]);
+    refresh(board, 1, accumulator.values[1]);
+    return evaluate(accumulator, board.getSideToMove());
+}
+
+void NnueAccumulatorStack::reset(const NnueNetwork& network, const Board& board) {
+    m_size = 1;
+    Entry& root = m_entries[0];
+    network.refresh(board, 0, root.accumulator.values[0]);
+    network.refresh(board, 1, root.accumulator.values[1]);
+    root.computed[0] = root.computed[1] = true;
+    root.refreshNeeded[0] = root.refreshNeeded[1] = false;
+    root.dirtyCount = 0;
+}
+
+void NnueAccumulatorStack::push(const Board& board, Move move, const UndoInfo& undo) {
+    Entry& entry = m_entries[m_size++];
+    entry.computed[0] = entry.computed[1] = false;
+    entry.refreshNeeded[0] = entry.refreshNeeded[1] = false;
+    entry.dirtyCount = 0;
+
+    const int from = move.getFrom();
+    const int to = move.getTo();
+    const int us = colourIndex(oppositeColour(board.getSideToMove()));
+    const std::uint8_t placed = board.getPieceCode(to);
+
+    if (move.isPromotion()) {
+        std::uint8_t pawn = static_cast<std::uint8_t>((us << 3) | static_cast<int>(PieceType::PAWN));
+        entry.dirty[entry.dirtyCount++] = {pawn, static_cast<std::int8_t>(from), NO_SQUARE};
+        entry.dirty[entry.dirtyCount++] = {placed, NO_SQUARE, static_cast<std::int8_t>(to)};
+    } else {
+        entry.dirty[entry.dirtyCount++] = {placed, static_cast<std::int8_t>(from), static_cast<std::int8_t>(to)};
+    }
+
+    if (undo.capturedPiece != 0) {
+        int victim = move.getFlags() == EN_PASSANT ? to + (us == 0 ? -8 : 8) : to;
+        entry.dirty[entry.dirtyCount++] = {undo.capturedPiece, static_cast<std::int8_t>(victim), NO_SQUARE};
+    }
+
+    if (move.isCastle()) {
+        std::uint8_t rook = static_cast<std::uint8_t>((us << 3) | static_cast<int>(PieceType::ROOK));
+        int rookFrom = move.getFlags() == KING_CASTLE ? to + 1 : to - 2;
+        int rookTo = move.getFlags() == KING_CASTLE ? to - 1 : to + 1;
+        entry.dirty[entry.dirtyCount++] = {rook, static_cast<std::int8_t>(rookFrom), static_cast<std::int8_t>(rookTo)};
+    }
+
+    // every feature of the mover's perspective depends on its king bucket.
+    if ((placed & 7) == static_cast<int>(PieceType::KING) &&
+        NnueNetwork::getKingBucket(us, from) != NnueNetwork::getKingBucket(us, to)) {
+        entry.refreshNeeded[us] = true;
+    }
+}
+
+void NnueAccumulatorStack::pushNull() {
+    Entry& entry = m_entries[m_size++];
+    entry.computed[0] = entry.computed[1] = false;
+    entry.refreshNeeded[0] = entry.refreshNeeded[1] = false;
+    entry.dirtyCount = 0;
+}
+
+void NnueAccumulatorStack::pop() {
+    --m_size;
+}
+
+int NnueAccumulatorStack::evaluate(const NnueNetwork& network, const Board& board) {
+    updatePerspective(network, board, 0);
+    updatePerspective(network, board, 1);
+    return network.evaluate(m_entries[m_size - 1].accumulator, board.getSideToMove());
+}
+
+void NnueAccumulatorStack::updatePerspective(const NnueNetwork& network, const Board& board, int perspective) {
+    const int top = m_size - 1;
+    if (m_entries[top].computed[perspective]) {
+        return;
+    }
+
+    // walk back to the nearest computed accumulator; a king bucket change on the way means
+    // replaying is no cheaper than starting over.
+    int base = top;
+    while (!m_entries[base].computed[perspective]) {
+        if (m_entries[base].refreshNeeded[perspective] || base == 0) {
+            network.refresh(board, perspective, m_entries[top].accumulator.values[perspective]);
+            m_entries[top].computed[perspective] = true;
+            return;
+        }
+        --base;
+    }
+
+    // the king bucket is the same all the way up, so the current king square indexes every step.
+    const int kingSquare = board.findKing(colourFromIndex(perspective));
+    for (int index = base + 1; index <= top; ++index) {
+        const Entry& entry = m_entries[index];
+        int added[3];
+        int removed[3];
+        int addedCount = 0;
+        int removedCount = 0;
+
+        for (int i = 0; i < entry.dirtyCount; ++i) {
+            const DirtyPiece& piece = entry.dirty[i];
+            if (piece.from != NO_SQUARE) {
+                removed[removedCount++] = NnueNetwork::getFeatureIndex(perspective, kingSquare, piece.code, piece.from);
+            }
+            if (piece.to != NO_SQUARE) {
+                added[addedCount++] = NnueNetwork::getFeatureIndex(perspective, kingSquare, piece.code, piece.to);
+            }
+        }
+
+        network.update(m_entries[index - 1].accumulator.values[perspective], m_entries[index].accumulator.values[perspective],
+                       added, addedCount, removed, removedCount);
+        m_entries[index].computed[perspective] = true;
+    }
+}
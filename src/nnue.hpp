@@ -0,0 +1,149 @@
+#ifndef NNUE_HPP
+#define NNUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+#include "move.hpp"
+
+// small efficiently-updatable network: HalfKA-style inputs (every piece including kings, by
+// colour relative to the perspective, relative square and king bucket) into HIDDEN int16
+// neurons per perspective, clipped to [0, 127] and summed through int8 output weights.
+constexpr int NNUE_KING_BUCKETS = 4;
+constexpr int NNUE_INPUTS = NNUE_KING_BUCKETS * 768;
+constexpr int NNUE_HIDDEN = 256;
+
+// weights are int8 in units of 1/64 and output weights also 1/64, so the output sum is
+// scaled down by 64 * 64 before the file's own centipawn scale is applied.
+constexpr int NNUE_WEIGHT_SCALE = 64 * 64;
+
+// the on-disk layout: this header, then int16 feature biases[HIDDEN], int8 feature
+// weights[INPUTS][HIDDEN], int8 output weights[2 * HIDDEN] (side to move first) and an int32
+// output bias, all little endian and unpadded.
+struct NnueHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t inputs;
+    std::uint32_t hidden;
+    std::int32_t outputScale;
+    std::uint32_t reserved[10];
+};
+
+constexpr char NNUE_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'N', 'N', '1'};
+constexpr std::uint32_t NNUE_VERSION = 1;
+
+enum class SimdLevel {
+    SCALAR,
+    SSE41,
+    AVX2,
+};
+
+// the best kernels this CPU supports, detected once at startup.
+SimdLevel getSupportedSimdLevel();
+SimdLevel getSimdLevel();
+
+// switches kernels, e.g. to benchmark them against each other. clamped to what is supported;
+// not to be called while a search is running.
+void setSimdLevel(SimdLevel level);
+const char* getSimdLevelName(SimdLevel level);
+
+struct alignas(32) NnueAccumulator {
+    std::int16_t values[2][NNUE_HIDDEN];
+};
+
+// read-only weights, memory-mapped from a network file and shared by every search thread.
+class NnueNetwork {
+public:
+    NnueNetwork() = default;
+    ~NnueNetwork();
+
+    NnueNetwork(const NnueNetwork&) = delete;
+    NnueNetwork& operator=(const NnueNetwork&) = delete;
+
+    // returns false, leaving the network unloaded, if the file is missing or malformed.
+    bool load(const std::string& path);
+    void unload();
+
+    bool isLoaded() const {
+        return m_featureWeights != nullptr;
+    }
+
+    const std::string& getPath() const {
+        return m_path;
+    }
+
+    // feature index of a piece as seen by perspective (0 white, 1 black).
+    static int getFeatureIndex(int perspective, int kingSquare, std::uint8_t pieceCode, int square);
+    static int getKingBucket(int perspective, int kingSquare);
+
+    // accumulator half of perspective computed from scratch.
+    void refresh(const Board& board, int perspective, std::int16_t* values) const;
+
+    // dst = src plus the added feature rows minus the removed ones.
+    void update(const std::int16_t* src, std::int16_t* dst, const int* added, int addedCount, const int* removed,
+                int removedCount) const;
+
+    // centipawns from the side to move's point of view.
+    int evaluate(const NnueAccumulator& accumulator, PieceColour sideToMove) const;
+
+    // full refresh and evaluation, for one-off use outside the search.
+    int evaluate(const Board& board) const;
+
+private:
+    std::string m_path;
+    void* m_mapping = nullptr;
+    std::size_t m_mappingSize = 0;
+    std::vector<char> m_buffer;
+
+    const std::int16_t* m_featureBiases = nullptr;
+    const std::int8_t* m_featureWeights = nullptr;
+    const std::int8_t* m_outputWeights = nullptr;
+    std::int32_t m_outputBias = 0;
+    std::int32_t m_outputScale = 0;
+};
+
+// accumulators for the positions along the current search line. make pushes a record of the
+// pieces that moved; the accumulator itself is only brought up to date when the position is
+// evaluated, by replaying those records from the nearest computed ancestor, or by a refresh
+// when a king changed bucket on the way.
+class NnueAccumulatorStack {
+public:
+    static constexpr int CAPACITY = 256;
+
+    void reset(const NnueNetwork& network, const Board& board);
+
+    // call after board.makeMove(move, undo).
+    void push(const Board& board, Move move, const UndoInfo& undo);
+    void pushNull();
+    void pop();
+
+    int evaluate(const NnueNetwork& network, const Board& board);
+
+private:
+    // up to three pieces change per move: the mover, a capture and a castling rook. an add
+    // has from == NO_SQUARE and a removal to == NO_SQUARE.
+    struct DirtyPiece {
+        std::uint8_t code;
+        std::int8_t from;
+        std::int8_t to;
+    };
+
+    struct Entry {
+        NnueAccumulator accumulator;
+        bool computed[2];
+        bool refreshNeeded[2];
+        int dirtyCount;
+        DirtyPiece dirty[3];
+    };
+
+    void updatePerspective(const NnueNetwork& network, const Board& board, int perspective);
+
+private:
+    Entry m_entries[CAPACITY];
+    int m_size = 0;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "pawnhash.hpp"
+#include "board.hpp"
+#include "evaluate.hpp"
+
+#include <algorithm>
+
+PawnHashTable::PawnHashTable(std::size_t entries)
+    : m_entries(entries)
+    , m_mask(entries - 1) {}
+
+const PawnEntry& PawnHashTable::probe(const Board& board) {
+    std::uint64_t key = board.getPawnKey();
+    PawnEntry& entry = m_entries[key & m_mask];
+
+    ++m_stats.probes;
+    if (entry.key == key) {
+        ++m_stats.hits;
+        return entry;
+    }
+
+    entry = evaluatePawns(board);
+    return entry;
+}
+
+// an empty entry is also the correct entry for "no pawns at all" (key 0, score 0).
+void PawnHashTable::clear() {
+    std::fill(m_entries.begin(), m_entries.end(), PawnEntry());
+}
@@ -0,0 +1,47 @@
+#ifndef PAWNHASH_HPP
+#define PAWNHASH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "psqt.hpp"
+#include "transpositiontable.hpp"
+
+class Board;
+
+// everything the evaluation derives from the pawns alone.
+struct PawnEntry {
+    std::uint64_t key = 0;
+    Score score;
+    Bitboard passedPawns[2] = {0, 0};
+};
+
+// small always-replace cache of pawn structure evaluations keyed by Board::getPawnKey().
+// each search thread owns one, so there is no sharing and no locking.
+class PawnHashTable {
+public:
+    static constexpr std::size_t DEFAULT_ENTRIES = 1 << 16;
+
+    explicit PawnHashTable(std::size_t entries = DEFAULT_ENTRIES);
+
+    // the cached entry for the board's pawns, evaluated and stored first on a miss.
+    const PawnEntry& probe(const Board& board);
+
+    void clear();
+
+    const TTStats& getStats() const {
+        return m_stats;
+    }
+
+    void resetStats() {
+        m_stats = TTStats();
+    }
+
+private:
+    std::vector<PawnEntry> m_entries;
+    std::size_t m_mask;
+    TTStats m_stats;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "perft.hpp"
+#include "movelogic.hpp"
+
+std::uint64_t perft(Board& board, int depth, bool bulkCount) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    MoveLogic::generateLegalMoves(board, moves);
+
+    if (bulkCount && depth == 1) {
+        return moves.size();
+    }
+
+    std::uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        UndoInfo undo;
+        board.makeMove(move, undo);
+        nodes += perft(board, depth - 1, bulkCount);
+        board.unmakeMove(move, undo);
+    }
+
+    return nodes;
+}
+
+std::vector<PerftDivide> perftDivide(Board& board, int depth, bool bulkCount) {
+    std::vector<PerftDivide> divide;
+    if (depth < 1) {
+        return divide;
+    }
+
+    MoveList moves;
+    MoveLogic::generateLegalMoves(board, moves);
+    divide.reserve(moves.size());
+
+    for (const Move& move : moves) {
+        UndoInfo undo;
+        board.makeMove(move, undo);
+        divide.push_back({move, perft(board, depth - 1, bulkCount)});
+        board.unmakeMove(move, undo);
+    }
+
+    return divide;
+}
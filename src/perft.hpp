@@ -0,0 +1,22 @@
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "board.hpp"
+#include "move.hpp"
+
+struct PerftDivide {
+    Move move;
+    std::uint64_t nodes;
+};
+
+// counts leaf nodes of the legal move tree. with bulkCount the last ply returns the size
+// of the legal move list instead of making each move.
+std::uint64_t perft(Board& board, int depth, bool bulkCount = true);
+
+// perft split by root move, in generation order.
+std::vector<PerftDivide> perftDivide(Board& board, int depth, bool bulkCount = true);
+
+#endif
@@ -0,0 +1,76 @@
+#include "profiler.hpp"
+
+#ifdef CHESS_PROFILER
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+std::vector<std::unique_ptr<ProfilerMetric>>& metrics() {
+    static std::vector<std::unique_ptr<ProfilerMetric>> registered;
+    return registered;
+}
+
+} // namespace
+
+ProfilerMetric::ProfilerMetric(const char* name, MetricKind kind)
+    : m_name(name)
+    , m_kind(kind)
+    , m_samples{}
+    , m_sampleCount(0)
+    , m_nextSample(0)
+    , m_frameCount(0) {}
+
+void ProfilerMetric::addSample(float value) {
+    m_samples[m_nextSample] = value;
+    m_nextSample = (m_nextSample + 1) % PROFILER_HISTORY;
+    m_sampleCount = std::min(m_sampleCount + 1, PROFILER_HISTORY);
+}
+
+float ProfilerMetric::getPercentile(float fraction) const {
+    if (m_sampleCount == 0) {
+        return 0.0f;
+    }
+
+    float sorted[PROFILER_HISTORY];
+    std::copy(m_samples, m_samples + m_sampleCount, sorted);
+
+    float* nth = sorted + std::min(static_cast<int>(fraction * m_sampleCount), m_sampleCount - 1);
+    std::nth_element(sorted, nth, sorted + m_sampleCount);
+    return *nth;
+}
+
+float ProfilerMetric::getMaximum() const {
+    return m_sampleCount == 0 ? 0.0f : *std::max_element(m_samples, m_samples + m_sampleCount);
+}
+
+void ProfilerMetric::endFrame() {
+    if (m_kind == MetricKind::COUNTER) {
+        addSample(static_cast<float>(m_frameCount));
+        m_frameCount = 0;
+    }
+}
+
+ProfilerMetric& Profiler::getMetric(const char* name, MetricKind kind) {
+    for (const std::unique_ptr<ProfilerMetric>& metric : metrics()) {
+        if (std::strcmp(metric->getName(), name) == 0) {
+            return *metric;
+        }
+    }
+
+    metrics().push_back(std::make_unique<ProfilerMetric>(name, kind));
+    return *metrics().back();
+}
+
+const std::vector<std::unique_ptr<ProfilerMetric>>& Profiler::getMetrics() {
+    return metrics();
+}
+
+void Profiler::endFrame() {
+    for (const std::unique_ptr<ProfilerMetric>& metric : metrics()) {
+        metric->endFrame();
+    }
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+// CHESS_PROFILER is defined for debug builds and by the CHESS_PROFILER CMake option. without it
+// every PROFILE_ macro expands to nothing and this header declares nothing else, so release
+// builds carry no timers.
+#ifdef CHESS_PROFILER
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class MetricKind {
+    TIMER,
+    COUNTER,
+};
+
+constexpr int PROFILER_HISTORY = 240;
+
+// a rolling window of the last PROFILER_HISTORY samples: microseconds per scope for a timer,
+// the total per rendered frame for a counter. only the main thread records or reads metrics.
+class ProfilerMetric {
+public:
+    ProfilerMetric(const char* name, MetricKind kind);
+
+    void addSample(float value);
+
+    void addCount(std::uint64_t count) {
+        m_frameCount += count;
+    }
+
+    const char* getName() const {
+        return m_name;
+    }
+
+    MetricKind getKind() const {
+        return m_kind;
+    }
+
+    // the ring buffer and the index of its oldest sample, as ImGui::PlotLines takes them.
+    const float* getSamples() const {
+        return m_samples;
+    }
+    int getSampleCount() const {
+        return m_sampleCount;
+    }
+    int getOldestSample() const {
+        return m_sampleCount < PROFILER_HISTORY ? 0 : m_nextSample;
+    }
+
+    // e.g. 0.5f for the median of the window; 0 while it is empty.
+    float getPercentile(float fraction) const;
+
+    float getMaximum() const;
+
+private:
+    friend class Profiler;
+    void endFrame();
+
+private:
+    const char* m_name;
+    MetricKind m_kind;
+    float m_samples[PROFILER_HISTORY];
+    int m_sampleCount;
+    int m_nextSample;
+    std::uint64_t m_frameCount;
+};
+
+class Profiler {
+public:
+    // the metric called name, created on first use. names are compared by content, so scopes
+    // in different functions can share one.
+    static ProfilerMetric& getMetric(const char* name, MetricKind kind);
+
+    // in the order they were first used.
+    static const std::vector<std::unique_ptr<ProfilerMetric>>& getMetrics();
+
+    // closes the frame's counters.
+    static void endFrame();
+};
+
+// records the time from construction to destruction into a timer.
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilerMetric& metric)
+        : m_metric(metric)
+        , m_start(std::chrono::steady_clock::now()) {}
+
+    ~ProfileScope() {
+        m_metric.addSample(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - m_start).count());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilerMetric& m_metric;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// times the rest of the enclosing block.
+#define PROFILE_SCOPE(name)                                                                                        \
+    static ProfilerMetric& PROFILE_CONCAT(profileMetric, __LINE__) = Profiler::getMetric(name, MetricKind::TIMER); \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileMetric, __LINE__))
+
+#define PROFILE_COUNT(name, count)                                                             \
+    do {                                                                                       \
+        static ProfilerMetric& profileMetric = Profiler::getMetric(name, MetricKind::COUNTER); \
+        profileMetric.addCount(count);                                                         \
+    } while (false)
+
+#define PROFILE_END_FRAME() Profiler::endFrame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNT(name, count)
+#define PROFILE_END_FRAME()
+
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PSQT_HPP
+#define PSQT_HPP
+
+#include "bitboard.hpp"
+
+// a middlegame / endgame pair of centipawn values, blended by game phase in evaluate().
+struct Score {
+    int mg = 0;
+    int eg = 0;
+
+    constexpr Score() = default;
+
+    constexpr Score(int mg, int eg)
+        : mg(mg)
+        , eg(eg) {}
+
+    constexpr Score operator+(const Score& other) const {
+        return {mg + other.mg, eg + other.eg};
+    }
+
+    constexpr Score operator-(const Score& other) const {
+        return {mg - other.mg, eg - other.eg};
+    }
+
+    constexpr Score operator-() const {
+        return {-mg, -eg};
+    }
+
+    constexpr Score operator*(int factor) const {
+        return {mg * factor, eg * factor};
+    }
+
+    Score& operator+=(const Score& other) {
+        mg += other.mg;
+        eg += other.eg;
+        return *this;
+    }
+
+    Score& operator-=(const Score& other) {
+        mg -= other.mg;
+        eg -= other.eg;
+        return *this;
+    }
+};
+
+// game phase contributed by each piece type (pawn ... king); 24 is the full opening set.
+constexpr int PHASE_WEIGHTS[6] = {0, 2, 1, 1, 4, 0};
+constexpr int MAX_PHASE = 24;
+
+namespace detail {
+
+// material plus piece-square bonus, already signed: positive for white, negative for black.
+extern Score PSQT[2][6][64];
+
+} // namespace detail
+
+// what a piece on square adds to the board's white-minus-black material + PST sum.
+inline Score getPieceSquareScore(int colour, int piece, int square) {
+    return detail::PSQT[colour][piece][square];
+}
+
+#endif
@@ -0,0 +1,748 @@
+#include "search.hpp"
+#include "evaluate.hpp"
+#include "movelogic.hpp"
+#include "movepicker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+constexpr int ASPIRATION_DEPTH = 4;
+constexpr int ASPIRATION_WINDOW = 25;
+
+// stored in the hash table for nodes whose static evaluation was not computed (in check).
+constexpr int NO_EVAL = -INFINITE_SCORE - 1;
+
+constexpr int REVERSE_FUTILITY_DEPTH = 6;
+constexpr int REVERSE_FUTILITY_MARGIN = 80;
+constexpr int RAZORING_DEPTH = 2;
+constexpr int RAZORING_MARGIN = 300;
+constexpr int NULL_MOVE_DEPTH = 3;
+constexpr int FUTILITY_DEPTH = 6;
+constexpr int FUTILITY_MARGIN = 100;
+constexpr int LMR_DEPTH = 3;
+
+// late move reductions grow with the log of both the depth and the move number: late
+// moves at high depth are the least likely to matter.
+struct ReductionTable {
+    ReductionTable() {
+        for (int depth = 0; depth < MAX_PLY; ++depth) {
+            for (int moveCount = 0; moveCount < 64; ++moveCount) {
+                reductions[depth][moveCount] =
+                    depth && moveCount ? static_cast<int>(0.75 + std::log(depth) * std::log(moveCount) / 2.25) : 0;
+            }
+        }
+    }
+
+    int get(int depth, int moveCount) const {
+        return reductions[std::min(depth, MAX_PLY - 1)][std::min(moveCount, 63)];
+    }
+
+    int reductions[MAX_PLY][64];
+};
+
+const ReductionTable REDUCTIONS;
+
+// mate scores are stored relative to the node rather than the root, so the same entry
+// reads correctly wherever the position is reached.
+int scoreToTT(int score, int ply) {
+    if (score >= MATE_IN_MAX_PLY) {
+        return score + ply;
+    }
+    if (score <= -MATE_IN_MAX_PLY) {
+        return score - ply;
+    }
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score >= MATE_IN_MAX_PLY) {
+        return score - ply;
+    }
+    if (score <= -MATE_IN_MAX_PLY) {
+        return score + ply;
+    }
+    return score;
+}
+
+// helper threads skip some depths so that they spread over several iterations instead of
+// racing the main thread through the same one.
+constexpr int SKIP_SIZE[20] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr int SKIP_PHASE[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+// moves the entry towards +/-MAX_HISTORY by bonus, slowing down as it gets close, so the
+// table never saturates and recent results outweigh old ones.
+void updateHistory(int& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+}
+
+} // namespace
+
+Search::Search(TranspositionTable& transpositionTable)
+    : m_transpositionTable(transpositionTable)
+    , m_stopRequested(false)
+    , m_pondering(false) {
+    setThreadCount(1);
+}
+
+Search::~Search() = default;
+
+void Search::setThreadCount(int threadCount) {
+    threadCount = std::max(threadCount, 1);
+
+    m_workers.resize(std::min<std::size_t>(m_workers.size(), threadCount));
+    while (static_cast<int>(m_workers.size()) < threadCount) {
+        m_workers.push_back(std::make_unique<SearchWorker>(*this, static_cast<int>(m_workers.size())));
+    }
+}
+
+SearchResult Search::run(const Board& board, const SearchLimits& limits, const ProgressCallback& onIteration) {
+    m_limits = limits;
+    m_startTime = std::chrono::steady_clock::now();
+    m_transpositionTable.newSearch();
+
+    MoveList rootMoves;
+    MoveLogic::generateLegalMoves(board, rootMoves);
+    if (rootMoves.empty()) {
+        SearchResult result;
+        result.score = board.getCheckers() ? -MATE_SCORE : 0;
+        return result;
+    }
+
+    std::vector<std::thread> helpers;
+    helpers.reserve(m_workers.size() - 1);
+    for (std::size_t i = 1; i < m_workers.size(); ++i) {
+        helpers.emplace_back([this, i, &board] { m_workers[i]->iterativeDeepening(board, nullptr); });
+    }
+
+    SearchResult result = m_workers[0]->iterativeDeepening(board, onIteration ? &onIteration : nullptr);
+
+    // the main thread decides when the search is over; helpers stop with it.
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    result.nodes = getNodes();
+    result.elapsedMs = getElapsedMs();
+    result.nodesPerSecond = result.elapsedMs > 0 ? result.nodes * 1000 / result.elapsedMs : result.nodes;
+    result.ttStats = TTStats();
+    result.pawnHashStats = TTStats();
+    result.orderingStats = OrderingStats();
+    for (const auto& worker : m_workers) {
+        result.ttStats.probes += worker->getTTStats().probes;
+        result.ttStats.hits += worker->getTTStats().hits;
+        result.pawnHashStats.probes += worker->getPawnHashStats().probes;
+        result.pawnHashStats.hits += worker->getPawnHashStats().hits;
+        result.orderingStats.cutoffs += worker->getOrderingStats().cutoffs;
+        result.orderingStats.firstMoveCutoffs += worker->getOrderingStats().firstMoveCutoffs;
+    }
+    result.hashfull = m_transpositionTable.getHashfull();
+    return result;
+}
+
+std::uint64_t Search::getNodes() const {
+    std::uint64_t nodes = 0;
+    for (const auto& worker : m_workers) {
+        nodes += worker->getNodes();
+    }
+    return nodes;
+}
+
+int Search::getElapsedMs() const {
+    return static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_startTime).count());
+}
+
+SearchWorker::SearchWorker(Search& search, int id)
+    : m_search(search)
+    , m_transpositionTable(search.m_transpositionTable)
+    , m_id(id)
+    , m_stopped(false)
+    , m_completedDepth(0)
+    , m_ponderHitMs(0)
+    , m_nodes(0)
+    , m_selDepth(0)
+    , m_network(nullptr)
+    , m_pvIndex(0)
+    , m_history{} {}
+
+SearchResult SearchWorker::iterativeDeepening(const Board& board, const ProgressCallback* onIteration) {
+    const SearchLimits& limits = m_search.m_limits;
+
+    m_board = board;
+    m_stopped = false;
+
+    const NnueNetwork* network = m_search.m_options.network;
+    m_network = network && network->isLoaded() ? network : nullptr;
+    if (m_network) {
+        m_accumulators.reset(*m_network, m_board);
+    }
+    m_completedDepth = 0;
+    m_ponderHitMs = limits.ponder ? -1 : 0;
+    m_nodes.store(0, std::memory_order_relaxed);
+    m_selDepth = 0;
+    m_ttStats = TTStats();
+    m_pawnTable.resetStats();
+    m_orderingStats = OrderingStats();
+
+    // killers are tied to plies of the previous search's tree; history only fades.
+    std::fill(&m_killers[0][0], &m_killers[0][0] + MAX_PLY * 2, Move());
+    for (auto& side : m_history) {
+        for (auto& from : side) {
+            for (int& entry : from) {
+                entry /= 2;
+            }
+        }
+    }
+
+    MoveList rootMoves;
+    MoveLogic::generateLegalMoves(m_board, rootMoves);
+
+    SearchResult result;
+    result.bestMove = rootMoves[0];
+
+    const int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    const int multiPv = isMainThread() ? std::clamp(m_search.m_options.multiPv, 1, rootMoves.size()) : 1;
+
+    // aspiration windows are centred on each line's score from the previous iteration.
+    std::vector<int> previousScores(multiPv, 0);
+
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (!isMainThread()) {
+            int index = (m_id - 1) % 20;
+            if (((depth + SKIP_PHASE[index]) / SKIP_SIZE[index]) % 2 != 0) {
+                continue;
+            }
+        }
+
+        m_selDepth = 0;
+        m_rootLines.clear();
+
+        for (m_pvIndex = 0; m_pvIndex < multiPv; ++m_pvIndex) {
+            int delta = ASPIRATION_WINDOW;
+            int alpha = -INFINITE_SCORE;
+            int beta = INFINITE_SCORE;
+
+            if (depth >= ASPIRATION_DEPTH) {
+                alpha = std::max(previousScores[m_pvIndex] - delta, -INFINITE_SCORE);
+                beta = std::min(previousScores[m_pvIndex] + delta, INFINITE_SCORE);
+            }
+
+            int score = 0;
+            while (true) {
+                score = searchRoot(depth, alpha, beta);
+
+                if (m_stopped) {
+                    break;
+                }
+
+                // widen only the side that failed, doubling the step each time.
+                if (score <= alpha) {
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(score - delta, -INFINITE_SCORE);
+                } else if (score >= beta) {
+                    beta = std::min(score + delta, INFINITE_SCORE);
+                } else {
+                    break;
+                }
+                delta *= 2;
+            }
+
+            if (m_stopped) {
+                break;
+            }
+
+            m_rootLines.push_back({score, std::vector<Move>(m_pv[0], m_pv[0] + m_pvLength[0])});
+        }
+
+        // an interrupted iteration is discarded.
+        if (m_stopped) {
+            break;
+        }
+
+        // a later line can come back better than an earlier one when the search is unstable.
+        std::stable_sort(m_rootLines.begin(), m_rootLines.end(),
+                         [](const RootLine& a, const RootLine& b) { return a.score > b.score; });
+        for (int i = 0; i < multiPv; ++i) {
+            previousScores[i] = m_rootLines[i].score;
+        }
+
+        const int score = m_rootLines[0].score;
+        m_completedDepth = depth;
+
+        if (!isMainThread()) {
+            continue;
+        }
+
+        result = makeResult(depth);
+
+        if (onIteration) {
+            (*onIteration)(result);
+        }
+
+        if (isPondering()) {
+            continue;
+        }
+
+        // a mate found within the searched depth cannot be improved on.
+        if (Search::isMateScore(score) && MATE_SCORE - std::abs(score) <= depth) {
+            break;
+        }
+
+        // another iteration takes several times longer than this one, so do not start
+        // one that cannot finish.
+        if (limits.moveTimeMs > 0 && getLimitElapsedMs() * 2 > limits.moveTimeMs) {
+            break;
+        }
+
+        if (m_search.m_stopRequested.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    // a ponder search may not return a move before the opponent has actually played.
+    while (isMainThread() && isPondering() && !m_search.m_stopRequested.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return result;
+}
+
+int SearchWorker::searchRoot(int depth, int alpha, int beta) {
+    return negamax(depth, 0, alpha, beta, true);
+}
+
+bool SearchWorker::isExcludedRootMove(Move move) const {
+    for (int i = 0; i < m_pvIndex; ++i) {
+        if (!m_rootLines[i].pv.empty() && m_rootLines[i].pv[0] == move) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int SearchWorker::negamax(int depth, int ply, int alpha, int beta, bool pvNode) {
+    m_pvLength[ply] = ply;
+
+    const SearchOptions& options = m_search.m_options;
+    const bool inCheck = m_board.getCheckers() != 0;
+
+    // a check is searched one ply deeper, so forcing lines are not cut off at the horizon.
+    if (inCheck && options.checkExtensions) {
+        ++depth;
+    }
+
+    if (depth <= 0) {
+        return quiescence(ply, alpha, beta);
+    }
+
+    if ((addNode() & 2047) == 0) {
+        checkLimits();
+    }
+    if (m_stopped) {
+        return 0;
+    }
+
+    m_selDepth = std::max(m_selDepth, ply);
+    const bool rootNode = ply == 0;
+
+    if (!rootNode) {
+        if (m_board.isRepetition() || m_board.isFiftyMoveRule()) {
+            return 0;
+        }
+        if (ply >= MAX_PLY - 1) {
+            return evaluatePosition();
+        }
+
+        // mate distance pruning: no line from here can beat a shorter mate already found.
+        alpha = std::max(alpha, -MATE_SCORE + ply);
+        beta = std::min(beta, MATE_SCORE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
+    const std::uint64_t key = m_board.getKey();
+    TTData ttData;
+    Move ttMove;
+
+    ++m_ttStats.probes;
+    const bool ttHit = m_transpositionTable.probe(key, ttData);
+    if (ttHit) {
+        ++m_ttStats.hits;
+        ttMove = ttData.move;
+
+        if (!pvNode && ttData.depth >= depth) {
+            int ttScore = scoreFromTT(ttData.score, ply);
+            if (ttData.bound == Bound::EXACT || (ttData.bound == Bound::LOWER && ttScore >= beta) ||
+                (ttData.bound == Bound::UPPER && ttScore <= alpha)) {
+                return ttScore;
+            }
+        }
+    }
+
+    int staticEval = NO_EVAL;
+    if (!inCheck) {
+        staticEval = ttHit && ttData.eval != NO_EVAL ? ttData.eval : evaluatePosition();
+    }
+
+    // node-level pruning, only where a wrong guess cannot change the principal variation.
+    if (!pvNode && !inCheck) {
+        // reverse futility: far enough above beta that a quiet move cannot fall back below it.
+        if (options.reverseFutility && depth <= REVERSE_FUTILITY_DEPTH && beta < MATE_IN_MAX_PLY &&
+            staticEval - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+            return staticEval;
+        }
+
+        // razoring: so far below alpha that only captures could help, so ask quiescence.
+        if (options.razoring && depth <= RAZORING_DEPTH && staticEval + RAZORING_MARGIN * depth <= alpha) {
+            int score = quiescence(ply, alpha, alpha + 1);
+            if (score <= alpha) {
+                return score;
+            }
+        }
+
+        // null move: if passing still fails high, a real move almost certainly would. not
+        // tried twice in a row, nor with only pawns left, where zugzwang makes passing the
+        // best "move" and the assumption breaks.
+        const PieceColour us = m_board.getSideToMove();
+        const Bitboard nonPawnMaterial = m_board.getOccupancy(us) & ~m_board.getPieces(us, PieceType::PAWN) &
+                                         ~m_board.getPieces(us, PieceType::KING);
+
+        if (options.nullMove && depth >= NULL_MOVE_DEPTH && staticEval >= beta && nonPawnMaterial &&
+            (ply == 0 || !m_playedMoves[ply - 1].isNull())) {
+            const int reduction = 3 + depth / 4 + std::min((staticEval - beta) / 200, 3);
+
+            m_playedMoves[ply] = Move();
+            UndoInfo undo;
+            makeNullMove(undo);
+            int score = -negamax(depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+            unmakeNullMove(undo);
+
+            if (m_stopped) {
+                return 0;
+            }
+
+            // an unproven mate from a null move is not trusted.
+            if (score >= beta) {
+                return score >= MATE_IN_MAX_PLY ? beta : score;
+            }
+        }
+    }
+
+    const int side = colourIndex(m_board.getSideToMove());
+    Move counterMove;
+    if (ply > 0 && !m_playedMoves[ply - 1].isNull()) {
+        const Move previous = m_playedMoves[ply - 1];
+        counterMove = m_counterMoves[1 - side][pieceIndex(m_playedPieces[ply - 1])][previous.getTo()];
+    }
+
+    MovePicker picker(m_board, ttMove, m_killers[ply], counterMove, m_history);
+
+    const int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove;
+    int moveCount = 0;
+
+    Move quietsSearched[64];
+    int quietCount = 0;
+
+    Move move;
+    while (!(move = picker.next()).isNull()) {
+        if (rootNode && isExcludedRootMove(move)) {
+            continue;
+        }
+
+        ++moveCount;
+        const bool quiet = !move.isCapture() && !move.isPromotion();
+
+        m_playedMoves[ply] = move;
+        m_playedPieces[ply] = m_board.getPieceType(move.getFrom());
+
+        UndoInfo undo;
+        makeMove(move, undo);
+        m_transpositionTable.prefetch(m_board.getKey());
+
+        const bool givesCheck = m_board.getCheckers() != 0;
+
+        // futility: a quiet move this close to the horizon is not going to recover a deficit
+        // this large. the first move is always searched so the node keeps a real score.
+        if (options.futility && !pvNode && !inCheck && quiet && !givesCheck && moveCount > 1 && depth <= FUTILITY_DEPTH &&
+            staticEval + FUTILITY_MARGIN * depth <= alpha) {
+            unmakeMove(move, undo);
+            continue;
+        }
+
+        const int newDepth = depth - 1;
+
+        // principal variation search: the first move gets the full window, the rest are
+        // only proven worse with a null window and re-searched if that fails. late quiet
+        // moves are first searched at reduced depth.
+        int score;
+        if (moveCount == 1) {
+            score = -negamax(newDepth, ply + 1, -beta, -alpha, pvNode);
+        } else {
+            int reduction = 0;
+            if (options.lateMoveReductions && depth >= LMR_DEPTH && quiet && !inCheck && !givesCheck) {
+                reduction = REDUCTIONS.get(depth, moveCount) - (pvNode ? 1 : 0);
+                reduction = std::clamp(reduction, 0, newDepth - 1);
+            }
+
+            score = -negamax(newDepth - reduction, ply + 1, -alpha - 1, -alpha, false);
+            if (score > alpha && reduction > 0) {
+                score = -negamax(newDepth, ply + 1, -alpha - 1, -alpha, false);
+            }
+            if (score > alpha && score < beta) {
+                score = -negamax(newDepth, ply + 1, -beta, -alpha, true);
+            }
+        }
+
+        unmakeMove(move, undo);
+
+        if (m_stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+                updatePv(ply, move);
+
+                if (alpha >= beta) {
+                    ++m_orderingStats.cutoffs;
+                    if (moveCount == 1) {
+                        ++m_orderingStats.firstMoveCutoffs;
+                    }
+                    if (quiet) {
+                        updateQuietStats(ply, depth, move, quietsSearched, quietCount);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (quiet && quietCount < 64) {
+            quietsSearched[quietCount++] = move;
+        }
+    }
+
+    if (moveCount == 0) {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    // a root searched without its best moves has no score of its own to store.
+    if (!rootNode || m_pvIndex == 0) {
+        Bound bound = bestScore >= beta ? Bound::LOWER : (alpha > originalAlpha ? Bound::EXACT : Bound::UPPER);
+        m_transpositionTable.store(key, bestMove, scoreToTT(bestScore, ply), staticEval, depth, bound);
+    }
+
+    return bestScore;
+}
+
+int SearchWorker::quiescence(int ply, int alpha, int beta) {
+    m_pvLength[ply] = ply;
+
+    if ((addNode() & 2047) == 0) {
+        checkLimits();
+    }
+    if (m_stopped) {
+        return 0;
+    }
+
+    m_selDepth = std::max(m_selDepth, ply);
+
+    if (ply >= MAX_PLY - 1) {
+        return evaluatePosition();
+    }
+
+    const bool inCheck = m_board.getCheckers() != 0;
+    int bestScore = -INFINITE_SCORE;
+
+    // stand pat: the side to move can usually do at least as well as its static score by
+    // declining every capture. not available in check, where every evasion is searched.
+    if (!inCheck) {
+        bestScore = evaluatePosition();
+        if (bestScore >= beta) {
+            return bestScore;
+        }
+        alpha = std::max(alpha, bestScore);
+    }
+
+    MovePicker picker(m_board, m_history);
+    int moveCount = 0;
+
+    Move move;
+    while (!(move = picker.next()).isNull()) {
+        ++moveCount;
+
+        UndoInfo undo;
+        makeMove(move, undo);
+        int score = -quiescence(ply + 1, -beta, -alpha);
+        unmakeMove(move, undo);
+
+        if (m_stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (inCheck && moveCount == 0) {
+        return -MATE_SCORE + ply;
+    }
+
+    return bestScore;
+}
+
+void SearchWorker::makeMove(Move move, UndoInfo& undo) {
+    m_board.makeMove(move, undo);
+    if (m_network) {
+        m_accumulators.push(m_board, move, undo);
+    }
+}
+
+void SearchWorker::unmakeMove(Move move, const UndoInfo& undo) {
+    m_board.unmakeMove(move, undo);
+    if (m_network) {
+        m_accumulators.pop();
+    }
+}
+
+void SearchWorker::makeNullMove(UndoInfo& undo) {
+    m_board.makeNullMove(undo);
+    if (m_network) {
+        m_accumulators.pushNull();
+    }
+}
+
+void SearchWorker::unmakeNullMove(const UndoInfo& undo) {
+    m_board.unmakeNullMove(undo);
+    if (m_network) {
+        m_accumulators.pop();
+    }
+}
+
+int SearchWorker::evaluatePosition() {
+    return m_network ? m_accumulators.evaluate(*m_network, m_board) : evaluate(m_board, m_pawnTable);
+}
+
+// a quiet move that caused a cutoff becomes a killer and the countermove of the previous
+// move; its history rises and the quiets tried before it fall by the same bonus.
+void SearchWorker::updateQuietStats(int ply, int depth, Move move, const Move* quietsSearched, int quietCount) {
+    if (m_killers[ply][0] != move) {
+        m_killers[ply][1] = m_killers[ply][0];
+        m_killers[ply][0] = move;
+    }
+
+    const int side = colourIndex(m_board.getSideToMove());
+    if (ply > 0 && !m_playedMoves[ply - 1].isNull()) {
+        const Move previous = m_playedMoves[ply - 1];
+        m_counterMoves[1 - side][pieceIndex(m_playedPieces[ply - 1])][previous.getTo()] = move;
+    }
+
+    const int bonus = std::min(depth * depth, MAX_HISTORY / 4);
+    updateHistory(m_history[side][move.getFrom()][move.getTo()], bonus);
+    for (int i = 0; i < quietCount; ++i) {
+        updateHistory(m_history[side][quietsSearched[i].getFrom()][quietsSearched[i].getTo()], -bonus);
+    }
+}
+
+void SearchWorker::checkLimits() {
+    // helpers run until the main thread says otherwise.
+    if (!isMainThread()) {
+        m_stopped = m_search.m_stopRequested.load(std::memory_order_relaxed);
+        return;
+    }
+
+    // depth 1 always completes so there is a searched move to return.
+    if (m_completedDepth == 0) {
+        return;
+    }
+
+    if (m_search.m_stopRequested.load(std::memory_order_relaxed)) {
+        m_stopped = true;
+        return;
+    }
+
+    if (isPondering()) {
+        return;
+    }
+
+    const SearchLimits& limits = m_search.m_limits;
+
+    if (limits.nodes > 0 && m_search.getNodes() >= limits.nodes) {
+        m_stopped = true;
+        return;
+    }
+
+    if (limits.moveTimeMs > 0 && getLimitElapsedMs() >= limits.moveTimeMs) {
+        m_stopped = true;
+    }
+}
+
+bool SearchWorker::isPondering() {
+    if (m_ponderHitMs >= 0) {
+        return false;
+    }
+
+    if (m_search.m_pondering.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    // first time this thread sees the ponder hit: the move time starts now.
+    m_ponderHitMs = m_search.getElapsedMs();
+    return false;
+}
+
+void SearchWorker::updatePv(int ply, Move move) {
+    m_pv[ply][ply] = move;
+    for (int next = ply + 1; next < m_pvLength[ply + 1]; ++next) {
+        m_pv[ply][next] = m_pv[ply + 1][next];
+    }
+    m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+}
+
+int SearchWorker::getLimitElapsedMs() const {
+    return m_search.getElapsedMs() - std::max(m_ponderHitMs, 0);
+}
+
+// progress reports count every thread's nodes but only the main thread's hash probes and
+// cutoffs, since the other threads' counters are not safe to read while they run.
+SearchResult SearchWorker::makeResult(int depth) const {
+    SearchResult result;
+    result.depth = depth;
+    result.selDepth = m_selDepth;
+    result.score = m_rootLines[0].score;
+    result.nodes = m_search.getNodes();
+    result.elapsedMs = m_search.getElapsedMs();
+    result.nodesPerSecond = result.elapsedMs > 0 ? result.nodes * 1000 / result.elapsedMs : result.nodes;
+    result.ttStats = m_ttStats;
+    result.pawnHashStats = m_pawnTable.getStats();
+    result.orderingStats = m_orderingStats;
+    result.hashfull = m_transpositionTable.getHashfull();
+    result.pv = m_rootLines[0].pv;
+    result.lines = m_rootLines;
+
+    if (!result.pv.empty()) {
+        result.bestMove = result.pv[0];
+    }
+    if (result.pv.size() > 1) {
+        result.ponderMove = result.pv[1];
+    }
+
+    return result;
+}
@@ -0,0 +1,261 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "board.hpp"
+#include "move.hpp"
+#include "movepicker.hpp"
+#include "nnue.hpp"
+#include "pawnhash.hpp"
+#include "transpositiontable.hpp"
+
+constexpr int MAX_PLY = 128;
+constexpr int INFINITE_SCORE = 32000;
+constexpr int MATE_SCORE = 31000;
+constexpr int MATE_IN_MAX_PLY = MATE_SCORE - MAX_PLY;
+
+// a zero field means "no limit of this kind"; with no limits at all the search runs until
+// stop() is called or MAX_PLY is reached.
+struct SearchLimits {
+    int depth = 0;
+    int moveTimeMs = 0;
+    std::uint64_t nodes = 0;
+
+    // search without limits until ponderHit() or stop(); the limits apply from ponderHit().
+    bool ponder = false;
+};
+
+// beta cutoffs, and how many of them came from the first move searched: the closer the
+// ratio is to 1, the better the move ordering.
+struct OrderingStats {
+    std::uint64_t cutoffs = 0;
+    std::uint64_t firstMoveCutoffs = 0;
+
+    double getFirstMoveCutoffRate() const {
+        return cutoffs ? static_cast<double>(firstMoveCutoffs) / cutoffs : 0.0;
+    }
+};
+
+// pruning, reduction and extension techniques, each switchable so they can be compared
+// against each other, and the evaluation to use. changes apply from the next search.
+struct SearchOptions {
+    bool nullMove = true;
+    bool lateMoveReductions = true;
+    bool reverseFutility = true;
+    bool futility = true;
+    bool razoring = true;
+    bool checkExtensions = true;
+
+    // how many of the best root moves to search with a full window and report, each with its
+    // own principal variation. helper threads only ever search the best one.
+    int multiPv = 1;
+
+    // evaluate with this network instead of the hand-crafted evaluation when it is loaded.
+    // not owned, and must outlive the search.
+    const NnueNetwork* network = nullptr;
+};
+
+// one of the best root moves with its score and principal variation.
+struct RootLine {
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+struct SearchResult {
+    Move bestMove;
+    Move ponderMove;
+    int score = 0;
+    int depth = 0;
+    int selDepth = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t nodesPerSecond = 0;
+    int elapsedMs = 0;
+    TTStats ttStats;
+    TTStats pawnHashStats;
+    OrderingStats orderingStats;
+    int hashfull = 0;
+    std::vector<Move> pv;
+
+    // the best root moves, best first: pv and score are lines[0]. more than one only when
+    // SearchOptions::multiPv asks for it.
+    std::vector<RootLine> lines;
+};
+
+class Search;
+
+// everything one search thread writes: its own copy of the position, PV stack, pawn hash
+// and counters. only the transposition table and the stop flags are shared between threads.
+class SearchWorker {
+public:
+    using ProgressCallback = std::function<void(const SearchResult&)>;
+
+    SearchWorker(Search& search, int id);
+
+    // iterative deepening on board. only the main worker (id 0) reports progress, applies
+    // the limits and returns a meaningful result.
+    SearchResult iterativeDeepening(const Board& board, const ProgressCallback* onIteration);
+
+    std::uint64_t getNodes() const {
+        return m_nodes.load(std::memory_order_relaxed);
+    }
+
+    const TTStats& getTTStats() const {
+        return m_ttStats;
+    }
+
+    const TTStats& getPawnHashStats() const {
+        return m_pawnTable.getStats();
+    }
+
+    const OrderingStats& getOrderingStats() const {
+        return m_orderingStats;
+    }
+
+private:
+    bool isMainThread() const {
+        return m_id == 0;
+    }
+
+    // single writer, so a plain load and store is enough for other threads to read it.
+    std::uint64_t addNode() {
+        std::uint64_t nodes = m_nodes.load(std::memory_order_relaxed) + 1;
+        m_nodes.store(nodes, std::memory_order_relaxed);
+        return nodes;
+    }
+
+    int searchRoot(int depth, int alpha, int beta);
+    bool isExcludedRootMove(Move move) const;
+    int negamax(int depth, int ply, int alpha, int beta, bool pvNode);
+    int quiescence(int ply, int alpha, int beta);
+
+    // board moves that also keep the NNUE accumulators in step when a network is in use.
+    void makeMove(Move move, UndoInfo& undo);
+    void unmakeMove(Move move, const UndoInfo& undo);
+    void makeNullMove(UndoInfo& undo);
+    void unmakeNullMove(const UndoInfo& undo);
+    int evaluatePosition();
+
+    void updateQuietStats(int ply, int depth, Move move, const Move* quietsSearched, int quietCount);
+    void checkLimits();
+    bool isPondering();
+    void updatePv(int ply, Move move);
+    int getLimitElapsedMs() const;
+    SearchResult makeResult(int depth) const;
+
+private:
+    Search& m_search;
+    TranspositionTable& m_transpositionTable;
+    int m_id;
+
+    Board m_board;
+    bool m_stopped;
+    int m_completedDepth;
+    int m_ponderHitMs;
+
+    std::atomic<std::uint64_t> m_nodes;
+    int m_selDepth;
+    TTStats m_ttStats;
+    OrderingStats m_orderingStats;
+
+    // pawn structure rarely changes between nodes; private to the thread, so never contended.
+    PawnHashTable m_pawnTable;
+
+    const NnueNetwork* m_network;
+    NnueAccumulatorStack m_accumulators;
+
+    Move m_pv[MAX_PLY][MAX_PLY];
+    int m_pvLength[MAX_PLY];
+
+    // multi-pv: the lines completed so far in this iteration, whose first moves the root
+    // skips while line m_pvIndex is searched.
+    std::vector<RootLine> m_rootLines;
+    int m_pvIndex;
+
+    // move ordering: two killers per ply, the reply that refuted each (piece, to square) of
+    // the opponent, and a from/to history of quiet cutoffs.
+    Move m_killers[MAX_PLY][2];
+    Move m_counterMoves[2][6][64];
+    HistoryTable m_history;
+
+    // the move played at each ply and the type of the piece that made it.
+    Move m_playedMoves[MAX_PLY];
+    PieceType m_playedPieces[MAX_PLY];
+};
+
+// iterative-deepening negamax alpha-beta with aspiration windows, principal variation
+// search and a quiescence search over captures. with more than one thread it runs Lazy
+// SMP: helper threads search the same position at staggered depths and share what they
+// find only through the transposition table; the main thread's result is returned.
+class Search {
+public:
+    using ProgressCallback = SearchWorker::ProgressCallback;
+
+    explicit Search(TranspositionTable& transpositionTable);
+    ~Search();
+
+    // neither may be called while run() is in progress.
+    void setThreadCount(int threadCount);
+
+    void setOptions(const SearchOptions& options) {
+        m_options = options;
+    }
+
+    const SearchOptions& getOptions() const {
+        return m_options;
+    }
+
+    int getThreadCount() const {
+        return static_cast<int>(m_workers.size());
+    }
+
+    // clears a previous stop and sets pondering for the next run. call it on the thread that
+    // will later stop or ponderhit, before handing the search to another thread, so neither
+    // request can land before the run starts and then be overwritten by it.
+    void prepare(const SearchLimits& limits) {
+        m_stopRequested.store(false, std::memory_order_relaxed);
+        m_pondering.store(limits.ponder, std::memory_order_relaxed);
+    }
+
+    // searches a copy of board, after prepare. onIteration is called after every completed
+    // depth.
+    SearchResult run(const Board& board, const SearchLimits& limits, const ProgressCallback& onIteration = nullptr);
+
+    // safe to call from any thread.
+    void stop() {
+        m_stopRequested.store(true, std::memory_order_relaxed);
+    }
+
+    // the move being pondered on was played: the running search continues as a normal one.
+    void ponderHit() {
+        m_pondering.store(false, std::memory_order_relaxed);
+    }
+
+    static bool isMateScore(int score) {
+        return score >= MATE_IN_MAX_PLY || score <= -MATE_IN_MAX_PLY;
+    }
+
+private:
+    friend class SearchWorker;
+
+    std::uint64_t getNodes() const;
+    int getElapsedMs() const;
+
+private:
+    TranspositionTable& m_transpositionTable;
+    SearchLimits m_limits;
+    SearchOptions m_options;
+
+    std::atomic<bool> m_stopRequested;
+    std::atomic<bool> m_pondering;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    std::vector<std::unique_ptr<SearchWorker>> m_workers;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "searchservice.hpp"
+
+#include <algorithm>
+
+SearchService::SearchService(TranspositionTable& transpositionTable)
+    : m_search(transpositionTable)
+    , m_jobPending(false)
+    , m_quit(false)
+    , m_searching(false)
+    , m_resultReady(false) {
+    m_thread = std::thread(&SearchService::threadLoop, this);
+}
+
+SearchService::~SearchService() {
+    m_search.stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void SearchService::start(const Board& board, const SearchLimits& limits) {
+    m_search.stop();
+    waitUntilIdle();
+
+    // the previous search has finished, so nothing else touches the result or progress.
+    m_resultReady.store(false, std::memory_order_relaxed);
+    SearchProgress stale;
+    m_progress.read(stale);
+
+    // a stop or ponderhit sent right after start returns must reach this search, even if the
+    // worker has not picked it up yet.
+    m_search.prepare(limits);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_board = board;
+        m_limits = limits;
+        m_jobPending = true;
+        m_searching.store(true, std::memory_order_release);
+    }
+    m_condition.notify_all();
+}
+
+void SearchService::stop() {
+    m_search.stop();
+}
+
+void SearchService::ponderHit() {
+    m_search.ponderHit();
+}
+
+void SearchService::setThreadCount(int threadCount) {
+    m_search.stop();
+    waitUntilIdle();
+    m_resultReady.store(false, std::memory_order_relaxed);
+    m_search.setThreadCount(threadCount);
+}
+
+void SearchService::setOptions(const SearchOptions& options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+}
+
+bool SearchService::pollResult(SearchResult& result) {
+    if (!m_resultReady.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    result = m_result;
+    m_resultReady.store(false, std::memory_order_relaxed);
+    return true;
+}
+
+void SearchService::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this] { return !m_jobPending && !m_searching.load(std::memory_order_relaxed); });
+}
+
+void SearchService::threadLoop() {
+    while (true) {
+        Board board;
+        SearchLimits limits;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_jobPending || m_quit; });
+            if (m_quit) {
+                return;
+            }
+            board = m_board;
+            limits = m_limits;
+            m_search.setOptions(m_options);
+            m_jobPending = false;
+        }
+
+        SearchResult result = m_search.run(board, limits, [this](const SearchResult& iteration) {
+            SearchProgress progress;
+            progress.depth = iteration.depth;
+            progress.selDepth = iteration.selDepth;
+            progress.score = iteration.score;
+            progress.nodes = iteration.nodes;
+            progress.nodesPerSecond = iteration.nodesPerSecond;
+            progress.elapsedMs = iteration.elapsedMs;
+            progress.hashfull = iteration.hashfull;
+            progress.ttHitRate = iteration.ttStats.getHitRate();
+            progress.pawnHashHitRate = iteration.pawnHashStats.getHitRate();
+            progress.firstMoveCutoffRate = iteration.orderingStats.getFirstMoveCutoffRate();
+            progress.pvLength = std::min(static_cast<int>(iteration.pv.size()), MAX_PROGRESS_PV);
+            std::copy(iteration.pv.begin(), iteration.pv.begin() + progress.pvLength, progress.pv);
+
+            progress.lineCount = std::min(static_cast<int>(iteration.lines.size()), MAX_PROGRESS_LINES);
+            for (int i = 0; i < progress.lineCount; ++i) {
+                const RootLine& line = iteration.lines[i];
+                ProgressLine& target = progress.lines[i];
+                target.score = line.score;
+                target.pvLength = std::min(static_cast<int>(line.pv.size()), MAX_PROGRESS_PV);
+                std::copy(line.pv.begin(), line.pv.begin() + target.pvLength, target.pv);
+            }
+            m_progress.publish(progress);
+        });
+
+        m_result = result;
+        m_resultReady.store(true, std::memory_order_release);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_searching.store(false, std::memory_order_release);
+        }
+        m_condition.notify_all();
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef SEARCHSERVICE_HPP
+#define SEARCHSERVICE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "search.hpp"
+#include "triplebuffer.hpp"
+
+constexpr int MAX_PROGRESS_PV = 16;
+constexpr int MAX_PROGRESS_LINES = 8;
+
+struct ProgressLine {
+    int score = 0;
+    int pvLength = 0;
+    Move pv[MAX_PROGRESS_PV];
+};
+
+// fixed-size snapshot of a running search, cheap to copy through the progress channel.
+struct SearchProgress {
+    int depth = 0;
+    int selDepth = 0;
+    int score = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t nodesPerSecond = 0;
+    int elapsedMs = 0;
+    int hashfull = 0;
+    double ttHitRate = 0.0;
+    double pawnHashHitRate = 0.0;
+    double firstMoveCutoffRate = 0.0;
+    int pvLength = 0;
+    Move pv[MAX_PROGRESS_PV];
+
+    // the multi-pv lines, best first; the first is the same as score and pv above.
+    int lineCount = 0;
+    ProgressLine lines[MAX_PROGRESS_LINES];
+};
+
+// runs searches on a dedicated worker thread. the owning (UI) thread starts, stops and
+// ponders, then polls: progress arrives through a lock-free triple buffer and the final
+// result through an acquire/release flag, so polling never blocks on the search.
+class SearchService {
+public:
+    explicit SearchService(TranspositionTable& transpositionTable);
+    ~SearchService();
+
+    SearchService(const SearchService&) = delete;
+    SearchService& operator=(const SearchService&) = delete;
+
+    // stops any running search, discarding its result, and searches a copy of board.
+    void start(const Board& board, const SearchLimits& limits);
+    void stop();
+    void ponderHit();
+
+    // stops any running search, discarding its result, before resizing the thread pool.
+    void setThreadCount(int threadCount);
+
+    int getThreadCount() const {
+        return m_search.getThreadCount();
+    }
+
+    // applied when the next search starts.
+    void setOptions(const SearchOptions& options);
+
+    bool isSearching() const {
+        return m_searching.load(std::memory_order_acquire);
+    }
+
+    // true when a newer snapshot than the last one read is available.
+    bool pollProgress(SearchProgress& progress) {
+        return m_progress.read(progress);
+    }
+
+    // true once per finished search.
+    bool pollResult(SearchResult& result);
+
+private:
+    void threadLoop();
+    void waitUntilIdle();
+
+private:
+    Search m_search;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_jobPending;
+    bool m_quit;
+    Board m_board;
+    SearchLimits m_limits;
+    SearchOptions m_options;
+
+    std::atomic<bool> m_searching;
+    std::atomic<bool> m_resultReady;
+    SearchResult m_result;
+    TripleBuffer<SearchProgress> m_progress;
+};
+
+#endif
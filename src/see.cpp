@@ -0,0 +1,129 @@
+#include "see.hpp"
+#include "attacks.hpp"
+#include "evaluate.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr PieceType CHEAPEST_FIRST[6] = {PieceType::PAWN,  PieceType::KNIGHT, PieceType::BISHOP,
+                                         PieceType::ROOK,  PieceType::QUEEN,  PieceType::KING};
+
+// the least valuable of attackers, returned as its type with its square in square.
+PieceType findLeastValuable(const Board& board, Bitboard attackers, PieceColour colour, int& square) {
+    for (PieceType type : CHEAPEST_FIRST) {
+        Bitboard pieces = attackers & board.getPieces(colour, type);
+        if (pieces) {
+            square = lsb(pieces);
+            return type;
+        }
+    }
+    return PieceType::EMPTY;
+}
+
+// the exchange with mover making the first capture, whoever is really to move.
+int exchange(const Board& board, Move move, PieceColour mover) {
+    if (move.isCastle()) {
+        return 0;
+    }
+
+    const int from = move.getFrom();
+    const int to = move.getTo();
+
+    const Bitboard diagonalSliders = board.getPieces(PieceType::BISHOP) | board.getPieces(PieceType::QUEEN);
+    const Bitboard straightSliders = board.getPieces(PieceType::ROOK) | board.getPieces(PieceType::QUEEN);
+
+    Bitboard occupied = board.getOccupancy() ^ squareBit(from);
+
+    // swapList[n] is the balance for the side making capture n if the exchange stopped
+    // right after it; the backward pass lets each side decline a recapture that loses.
+    int swapList[32];
+    int length = 1;
+
+    if (move.getFlags() == EN_PASSANT) {
+        occupied ^= squareBit(to + (mover == PieceColour::WHITE ? -8 : 8));
+        swapList[0] = getPieceValue(PieceType::PAWN);
+    } else {
+        swapList[0] = getPieceValue(board.getPieceType(to));
+    }
+
+    // value of the piece now standing on the target square.
+    int onSquare = getPieceValue(board.getPieceType(from));
+
+    if (move.isPromotion()) {
+        swapList[0] += getPieceValue(move.getPromotionType()) - getPieceValue(PieceType::PAWN);
+        onSquare = getPieceValue(move.getPromotionType());
+    }
+
+    Bitboard attackers = board.getAttackersTo(to, occupied) & occupied;
+    PieceColour side = oppositeColour(mover);
+
+    while (length < 32) {
+        Bitboard ours = attackers & board.getOccupancy(side);
+        if (!ours) {
+            break;
+        }
+
+        int square = NO_SQUARE;
+        PieceType type = findLeastValuable(board, ours, side, square);
+
+        // the king may only recapture when nothing defends the square any more.
+        if (type == PieceType::KING && (attackers & board.getOccupancy(oppositeColour(side)))) {
+            break;
+        }
+
+        swapList[length] = onSquare - swapList[length - 1];
+        ++length;
+        onSquare = getPieceValue(type);
+
+        occupied ^= squareBit(square);
+
+        // whatever stood behind the piece that just moved now attacks the square too.
+        if (type == PieceType::PAWN || type == PieceType::BISHOP || type == PieceType::QUEEN) {
+            attackers |= getBishopAttacks(to, occupied) & diagonalSliders;
+        }
+        if (type == PieceType::ROOK || type == PieceType::QUEEN) {
+            attackers |= getRookAttacks(to, occupied) & straightSliders;
+        }
+        attackers &= occupied;
+
+        side = oppositeColour(side);
+    }
+
+    while (--length > 0) {
+        swapList[length - 1] = std::min(swapList[length - 1], -swapList[length]);
+    }
+
+    return swapList[0];
+}
+
+} // namespace
+
+int staticExchange(const Board& board, Move move) {
+    return exchange(board, move, board.getSideToMove());
+}
+
+Bitboard getHangingPieces(const Board& board, PieceColour colour) {
+    const PieceColour them = oppositeColour(colour);
+    const Bitboard occupied = board.getOccupancy();
+
+    Bitboard hanging = 0;
+    Bitboard pieces = board.getOccupancy(colour) & ~board.getPieces(colour, PieceType::KING);
+
+    while (pieces) {
+        int square = popLsb(pieces);
+        Bitboard attackers = board.getAttackersTo(square, occupied) & board.getOccupancy(them);
+        if (!attackers) {
+            continue;
+        }
+
+        // the opponent opens with its cheapest attacker, whoever's turn it really is.
+        int from = NO_SQUARE;
+        findLeastValuable(board, attackers, them, from);
+        if (exchange(board, Move(from, square, CAPTURE), them) > 0) {
+            hanging |= squareBit(square);
+        }
+    }
+
+    return hanging;
+}
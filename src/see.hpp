@@ -0,0 +1,18 @@
+#ifndef SEE_HPP
+#define SEE_HPP
+
+#include "bitboard.hpp"
+#include "board.hpp"
+#include "move.hpp"
+
+// static exchange evaluation: the material the side to move wins (or loses, if negative)
+// when both sides keep recapturing on the target square with their least valuable piece,
+// each free to stop once continuing would lose. no moves are made; attackers are found
+// with attackers-to queries on a shrinking occupancy, which also uncovers x-ray sliders.
+// pins and checks are ignored.
+int staticExchange(const Board& board, Move move);
+
+// pieces of colour that the opponent can win material against by capturing them.
+Bitboard getHangingPieces(const Board& board, PieceColour colour);
+
+#endif
@@ -0,0 +1,186 @@
+#include "transpositiontable.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#endif
+
+namespace {
+
+// data word layout: move 16 | score 16 | eval 16 | depth 8 | generation 6 | bound 2.
+constexpr int DEPTH_OFFSET = 8;
+constexpr std::uint8_t GENERATION_MASK = 0x3F;
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+std::uint64_t packData(Move move, int score, int eval, int depth, Bound bound, std::uint8_t generation) {
+    return static_cast<std::uint64_t>(move.getData()) | (static_cast<std::uint64_t>(static_cast<std::uint16_t>(score)) << 16) |
+           (static_cast<std::uint64_t>(static_cast<std::uint16_t>(eval)) << 32) |
+           (static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth + DEPTH_OFFSET)) << 48) |
+           (static_cast<std::uint64_t>(generation & GENERATION_MASK) << 58) | (static_cast<std::uint64_t>(bound) << 56);
+}
+
+Move unpackMove(std::uint64_t data) {
+    return Move(static_cast<int>(data & 0x3F), static_cast<int>((data >> 6) & 0x3F), static_cast<int>((data >> 12) & 0xF));
+}
+
+int unpackDepth(std::uint64_t data) {
+    return static_cast<int>((data >> 48) & 0xFF) - DEPTH_OFFSET;
+}
+
+Bound unpackBound(std::uint64_t data) {
+    return static_cast<Bound>((data >> 56) & 3);
+}
+
+std::uint8_t unpackGeneration(std::uint64_t data) {
+    return static_cast<std::uint8_t>((data >> 58) & GENERATION_MASK);
+}
+
+void* allocateTable(std::size_t bytes, bool largePages) {
+#if defined(_WIN32)
+    (void)largePages;
+    return _aligned_malloc(bytes, 64);
+#else
+    std::size_t alignment = largePages && bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : 64;
+    void* memory = std::aligned_alloc(alignment, bytes);
+#    if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (memory && alignment == HUGE_PAGE_SIZE) {
+        madvise(memory, bytes, MADV_HUGEPAGE);
+    }
+#    endif
+    return memory;
+#endif
+}
+
+void freeTable(void* memory) {
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable()
+    : m_buckets(nullptr)
+    , m_bucketCount(0)
+    , m_generation(0)
+    , m_largePages(false) {
+    resize(16);
+}
+
+TranspositionTable::~TranspositionTable() {
+    release();
+}
+
+void TranspositionTable::release() {
+    if (m_buckets) {
+        freeTable(m_buckets);
+        m_buckets = nullptr;
+    }
+    m_bucketCount = 0;
+}
+
+void TranspositionTable::resize(std::size_t sizeMb, bool largePages) {
+    std::size_t bytes = (sizeMb ? sizeMb : 1) * 1024 * 1024;
+    std::size_t bucketCount = 1;
+    while (bucketCount * 2 * sizeof(Bucket) <= bytes) {
+        bucketCount *= 2;
+    }
+
+    release();
+
+    m_buckets = static_cast<Bucket*>(allocateTable(bucketCount * sizeof(Bucket), largePages));
+    if (!m_buckets) {
+        std::cerr << "Failed to allocate a " << sizeMb << " MB transposition table, falling back to 1 MB" << std::endl;
+        bucketCount = 1024 * 1024 / sizeof(Bucket);
+        m_buckets = static_cast<Bucket*>(allocateTable(bucketCount * sizeof(Bucket), false));
+        largePages = false;
+    }
+
+    m_bucketCount = bucketCount;
+    m_largePages = largePages;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    // the entries are plain words in memory; zeroing them is the same as storing 0.
+    std::memset(static_cast<void*>(m_buckets), 0, m_bucketCount * sizeof(Bucket));
+    m_generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    m_generation = (m_generation + 1) & GENERATION_MASK;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTData& data) const {
+    const Bucket* bucket = getBucket(key);
+
+    for (const Entry& entry : bucket->entries) {
+        std::uint64_t word = entry.data.load(std::memory_order_relaxed);
+        if ((entry.keyXorData.load(std::memory_order_relaxed) ^ word) != key || word == 0) {
+            continue;
+        }
+
+        data.move = unpackMove(word);
+        data.score = static_cast<std::int16_t>((word >> 16) & 0xFFFF);
+        data.eval = static_cast<std::int16_t>((word >> 32) & 0xFFFF);
+        data.depth = unpackDepth(word);
+        data.bound = unpackBound(word);
+        return true;
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, Move move, int score, int eval, int depth, Bound bound) {
+    Bucket* bucket = getBucket(key);
+    Entry* replace = &bucket->entries[0];
+    int replaceValue = 1 << 30;
+
+    for (Entry& entry : bucket->entries) {
+        std::uint64_t word = entry.data.load(std::memory_order_relaxed);
+
+        if ((entry.keyXorData.load(std::memory_order_relaxed) ^ word) == key) {
+            // same position: keep the old best move if the new result has none, and keep a
+            // deeper exact-enough result from this search.
+            if (move.isNull()) {
+                move = unpackMove(word);
+            }
+            if (bound != Bound::EXACT && unpackGeneration(word) == m_generation && unpackDepth(word) > depth + 2) {
+                return;
+            }
+            replace = &entry;
+            break;
+        }
+
+        // prefer to overwrite shallow entries and entries left over from older searches.
+        int age = (m_generation - unpackGeneration(word)) & GENERATION_MASK;
+        int value = word == 0 ? -(1 << 30) : unpackDepth(word) - 8 * age;
+        if (value < replaceValue) {
+            replaceValue = value;
+            replace = &entry;
+        }
+    }
+
+    std::uint64_t word = packData(move, score, eval, depth, bound, m_generation);
+    replace->keyXorData.store(key ^ word, std::memory_order_relaxed);
+    replace->data.store(word, std::memory_order_relaxed);
+}
+
+int TranspositionTable::getHashfull() const {
+    std::size_t samples = m_bucketCount < 250 ? m_bucketCount : 250;
+    int used = 0;
+
+    for (std::size_t i = 0; i < samples; ++i) {
+        for (const Entry& entry : m_buckets[i].entries) {
+            std::uint64_t word = entry.data.load(std::memory_order_relaxed);
+            used += word != 0 && unpackGeneration(word) == m_generation;
+        }
+    }
+
+    return samples ? static_cast<int>(used * 1000 / (samples * BUCKET_SIZE)) : 0;
+}
@@ -0,0 +1,107 @@
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <xmmintrin.h>
+#endif
+
+#include "move.hpp"
+
+enum class Bound : std::uint8_t {
+    NONE = 0,
+    UPPER = 1,
+    LOWER = 2,
+    EXACT = 3,
+};
+
+struct TTData {
+    Move move;
+    int score;
+    int eval;
+    int depth;
+    Bound bound;
+};
+
+// hit/probe counters owned by each search thread, so counting never shares a cache line.
+struct TTStats {
+    std::uint64_t probes = 0;
+    std::uint64_t hits = 0;
+
+    double getHitRate() const {
+        return probes ? static_cast<double>(hits) / probes : 0.0;
+    }
+};
+
+// shared hash table of search results. entries are two 64-bit words, the key stored XORed
+// with the data ("lockless hashing"): a torn write from two threads no longer matches any
+// key and reads as a miss, so no locks are needed. four entries share a 64-byte bucket
+// and a whole probe touches one cache line.
+class TranspositionTable {
+public:
+    TranspositionTable();
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // resizes to the largest power-of-two number of buckets that fits in sizeMb and clears
+    // the table. largePages asks the OS for transparent huge pages where supported.
+    void resize(std::size_t sizeMb, bool largePages = false);
+    void clear();
+
+    // call once per search so older entries become preferred replacement victims.
+    void newSearch();
+
+    bool probe(std::uint64_t key, TTData& data) const;
+    void store(std::uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+
+    // issued right after makeMove so the bucket is on its way while the child node sets up.
+    void prefetch(std::uint64_t key) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(getBucket(key));
+#elif defined(_MSC_VER)
+        _mm_prefetch(reinterpret_cast<const char*>(getBucket(key)), _MM_HINT_T0);
+#endif
+    }
+
+    // permille of sampled entries written during the current search.
+    int getHashfull() const;
+
+    std::size_t getSizeMb() const {
+        return m_bucketCount * sizeof(Bucket) / (1024 * 1024);
+    }
+
+    bool isUsingLargePages() const {
+        return m_largePages;
+    }
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> keyXorData;
+        std::atomic<std::uint64_t> data;
+    };
+
+    static constexpr int BUCKET_SIZE = 4;
+
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    Bucket* getBucket(std::uint64_t key) const {
+        return m_buckets + (key & (m_bucketCount - 1));
+    }
+
+    void release();
+
+private:
+    Bucket* m_buckets;
+    std::size_t m_bucketCount;
+    std::uint8_t m_generation;
+    bool m_largePages;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// single-producer single-consumer "latest value" channel. the writer fills its back slot
+// and swaps it with the shared middle slot; the reader swaps the middle slot into its
+// front slot only when something new was published. neither side ever waits, and the
+// reader always sees a complete value, possibly skipping intermediate ones.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer()
+        : m_middle(1)
+        , m_back(0)
+        , m_front(2) {}
+
+    // writer thread only.
+    void publish(const T& value) {
+        m_slots[m_back] = value;
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // reader thread only. returns false and leaves value untouched if nothing was published
+    // since the last successful read.
+    bool read(T& value) {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        value = m_slots[m_front];
+        return true;
+    }
+
+private:
+    static constexpr std::uint8_t INDEX_MASK = 3;
+    static constexpr std::uint8_t FRESH = 4;
+
+    T m_slots[3];
+    std::atomic<std::uint8_t> m_middle;
+    std::uint8_t m_back;
+    std::uint8_t m_front;
+};
+
+#endif
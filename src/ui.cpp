@@ -4,24 +4,41 @@
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_sdlrenderer2.h"
 #include "piece.hpp"
+#include "profiler.hpp"
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <utility>
 
-UI::UI(Chess* chess)
-    : m_chess(chess) {
+UI::UI(Chess* chess, Asset font)
+    : m_chess(chess)
+    , m_fontData(std::move(font))
+    , m_panelMin(0.0f, 0.0f)
+    , m_panelMax(0.0f, 0.0f) {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO io = ImGui::GetIO();
 
     io.Fonts->AddFontDefault();
-    ImFont* m_fontLargeLibreBaskerville = io.Fonts->AddFontFromFileTTF("resources/fonts/LibreBaskerville-Regular.ttf", 20.0f);
-    IM_ASSERT(m_fontLargeLibreBaskerville != NULL);
+
+    // the atlas only reads the data, which m_fontData keeps alive for as long as it may
+    // need rebuilding.
+    ImFontConfig fontConfig;
+    fontConfig.FontDataOwnedByAtlas = false;
+    ImFont* m_fontLargeLibreBaskerville =
+        m_fontData.isLoaded() ? io.Fonts->AddFontFromMemoryTTF(const_cast<unsigned char*>(m_fontData.getData()),
+                                                               static_cast<int>(m_fontData.getSize()), 20.0f, &fontConfig)
+                              : nullptr;
 
     ImGui_ImplSDL2_InitForSDLRenderer(m_chess->getWindow(), m_chess->getRenderer());
     ImGui_ImplSDLRenderer2_Init(m_chess->getRenderer());
 
     if (m_fontLargeLibreBaskerville == nullptr) {
-        std::cerr << "Error: Could not load font from resources/fonts/LibreBaskerville-Regular.ttf" << std::endl;
+        std::cerr << "Error: Could not load font fonts/LibreBaskerville-Regular.ttf" << std::endl;
     } else {
         std::cout << "Font loaded successfully!" << std::endl;
     }
@@ -47,12 +64,40 @@ void UI::renderInterfaces() {
     ImGui::Spacing();
     ImGui::Spacing();
     renderCapturePieces();
+    ImGui::NewLine();
+    ImGui::Spacing();
+    renderEvaluationBar();
+    ImGui::Spacing();
+
+    bool showHangingPieces = m_chess->isShowingHangingPieces();
+    if (ImGui::Checkbox("Show hanging pieces", &showHangingPieces)) {
+        m_chess->setShowHangingPieces(showHangingPieces);
+    }
+    ImGui::Spacing();
+
+    renderBoardSettings();
+    ImGui::Spacing();
+
+    renderEngineSettings();
+    ImGui::Spacing();
+
+    renderFrameStats();
+
+    m_panelMin = ImGui::GetWindowPos();
+    m_panelMax = ImVec2(m_panelMin.x + ImGui::GetWindowWidth(), m_panelMin.y + ImGui::GetWindowHeight());
 
     ImGui::End();
 
+    renderPromotionPopup();
+    renderProfiler();
+
     ImGui::Render();
 }
 
+bool UI::isPointerOverInterface(int x, int y) const {
+    return x >= m_panelMin.x && x < m_panelMax.x && y >= m_panelMin.y && y < m_panelMax.y;
+}
+
 void UI::renderCurrentPlayerIndicator() {
     PieceColour currentColour = m_chess->getCurrentTurn();
 
@@ -78,12 +123,8 @@ void UI::renderCapturePieces() {
     ImGui::Text("Captured White Pieces:");
     for (const Piece& piece : takenWhitePieces) {
         if (piece.type != PieceType::EMPTY) {
-            std::string textureKey = m_chess->getTextureKey(piece);
-            SDL_Texture* pieceTexture = m_chess->getTexture(textureKey);
-            if (pieceTexture) {
-                ImGui::Image(reinterpret_cast<ImTextureID>(pieceTexture), ImVec2(30, 30));
-                ImGui::SameLine();
-            }
+            renderPieceImage(piece, ImVec2(30, 30));
+            ImGui::SameLine();
         }
     }
     ImGui::NewLine();
@@ -92,12 +133,230 @@ void UI::renderCapturePieces() {
     ImGui::Text("Captured Black Pieces:");
     for (const Piece& piece : takenBlackPieces) {
         if (piece.type != PieceType::EMPTY) {
-            std::string textureKey = m_chess->getTextureKey(piece);
-            SDL_Texture* pieceTexture = m_chess->getTexture(textureKey);
-            if (pieceTexture) {
-                ImGui::Image(reinterpret_cast<ImTextureID>(pieceTexture), ImVec2(30, 30));
-                ImGui::SameLine();
+            renderPieceImage(piece, ImVec2(30, 30));
+            ImGui::SameLine();
+        }
+    }
+}
+
+void UI::renderPieceImage(const Piece& piece, const ImVec2& size) {
+    const BoardRenderer& boardRenderer = m_chess->getBoardRenderer();
+    AtlasRegion region = boardRenderer.getPieceRegion(piece.colour, piece.type);
+    ImGui::Image(reinterpret_cast<ImTextureID>(boardRenderer.getAtlas()), size, ImVec2(region.u0, region.v0),
+                 ImVec2(region.u1, region.v1));
+}
+
+void UI::renderEvaluationBar() {
+    const EvalTrace& evaluation = m_chess->getEvaluation();
+    ImGui::Text("Evaluation:");
+
+    // white's share of the bar follows a logistic curve, so +4 pawns fills about 90% of it.
+    float whiteShare = 1.0f / (1.0f + std::pow(10.0f, -evaluation.total / 400.0f));
+
+    ImVec2 size(ImGui::GetContentRegionAvail().x, 18.0f);
+    ImVec2 min = ImGui::GetCursorScreenPos();
+    ImVec2 split(min.x + size.x * whiteShare, min.y + size.y);
+    ImVec2 max(min.x + size.x, min.y + size.y);
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(min, split, IM_COL32(235, 235, 235, 255));
+    drawList->AddRectFilled(ImVec2(split.x, min.y), max, IM_COL32(30, 30, 30, 255));
+    drawList->AddRect(min, max, IM_COL32(128, 128, 128, 255));
+
+    char label[16];
+    std::snprintf(label, sizeof(label), "%+.2f", evaluation.total / 100.0f);
+    ImVec2 labelSize = ImGui::CalcTextSize(label);
+    ImU32 labelColour = evaluation.total >= 0 ? IM_COL32(30, 30, 30, 255) : IM_COL32(235, 235, 235, 255);
+    float labelX = evaluation.total >= 0 ? min.x + 4.0f : max.x - labelSize.x - 4.0f;
+    drawList->AddText(ImVec2(labelX, min.y + (size.y - labelSize.y) * 0.5f), labelColour, label);
+
+    ImGui::InvisibleButton("##EvaluationBar", size);
+    if (ImGui::IsItemHovered()) {
+        ImGui::BeginTooltip();
+        ImGui::Text("Phase: %d / %d", evaluation.phase, MAX_PHASE);
+        ImGui::Text("Material + PST: %+d / %+d", evaluation.psqt.mg, evaluation.psqt.eg);
+        ImGui::Text("Pawn structure: %+d / %+d", evaluation.pawns.mg, evaluation.pawns.eg);
+        ImGui::Text("Pieces: %+d / %+d", evaluation.pieces.mg, evaluation.pieces.eg);
+        ImGui::Text("Mobility: %+d / %+d", evaluation.mobility.mg, evaluation.mobility.eg);
+        ImGui::Text("King safety: %+d / %+d", evaluation.kingSafety.mg, evaluation.kingSafety.eg);
+        ImGui::TextDisabled("middlegame / endgame, centipawns for white");
+        ImGui::EndTooltip();
+    }
+}
+
+void UI::renderPromotionPopup() {
+    if (!m_chess->isPromotionPending()) {
+        return;
+    }
+
+    if (!ImGui::IsPopupOpen("Promote Pawn")) {
+        ImGui::OpenPopup("Promote Pawn");
+    }
+
+    if (ImGui::BeginPopupModal("Promote Pawn", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        const PieceType choices[] = {PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT};
+
+        const BoardRenderer& boardRenderer = m_chess->getBoardRenderer();
+        ImTextureID atlas = reinterpret_cast<ImTextureID>(boardRenderer.getAtlas());
+
+        for (PieceType type : choices) {
+            AtlasRegion region = boardRenderer.getPieceRegion(m_chess->getCurrentTurn(), type);
+
+            ImGui::PushID(static_cast<int>(type));
+            if (ImGui::ImageButton("##Promote", atlas, ImVec2(60, 60), ImVec2(region.u0, region.v0), ImVec2(region.u1, region.v1))) {
+                m_chess->promotePawn(type);
+                ImGui::CloseCurrentPopup();
             }
+            ImGui::PopID();
+            ImGui::SameLine();
         }
+
+        ImGui::EndPopup();
+    }
+}
+void UI::renderEngineSettings() {
+    EngineSettings& settings = m_chess->getEngineSettings();
+
+    ImGui::Checkbox("Play vs Engine", &settings.enabled);
+
+    if (!settings.enabled) {
+        return;
+    }
+
+    bool engineIsWhite = settings.engineColour == PieceColour::WHITE;
+    if (ImGui::RadioButton("Engine plays White", engineIsWhite)) {
+        settings.engineColour = PieceColour::WHITE;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Engine plays Black", !engineIsWhite)) {
+        settings.engineColour = PieceColour::BLACK;
+    }
+
+    ImGui::Checkbox("Limit by time", &settings.useTimeLimit);
+    if (settings.useTimeLimit) {
+        ImGui::SliderInt("Move time (ms)", &settings.moveTimeMs, 100, 10000);
+    } else {
+        ImGui::SliderInt("Depth", &settings.depth, 1, 20);
+    }
+
+    ImGui::Checkbox("Ponder", &settings.ponder);
+    ImGui::SliderInt("Threads", &settings.threads, 1, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+
+    bool networkLoaded = m_chess->getNetwork().isLoaded();
+    ImGui::BeginDisabled(!networkLoaded);
+    ImGui::Checkbox("NNUE evaluation", &settings.useNnue);
+    ImGui::EndDisabled();
+    if (!networkLoaded && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("No network at resources/nnue/default.nnue");
+    }
+
+    if (ImGui::CollapsingHeader("Search features")) {
+        SearchOptions& options = settings.searchOptions;
+        ImGui::Checkbox("Null-move pruning", &options.nullMove);
+        ImGui::Checkbox("Late move reductions", &options.lateMoveReductions);
+        ImGui::Checkbox("Reverse futility pruning", &options.reverseFutility);
+        ImGui::Checkbox("Futility pruning", &options.futility);
+        ImGui::Checkbox("Razoring", &options.razoring);
+        ImGui::Checkbox("Check extensions", &options.checkExtensions);
+    }
+
+    EngineState state = m_chess->getEngineState();
+    ImGui::Text("Engine: %s", state == EngineState::THINKING    ? "thinking"
+                              : state == EngineState::PONDERING ? "pondering"
+                                                                : "idle");
+
+    const SearchProgress& progress = m_chess->getEngineProgress();
+    if (progress.depth == 0) {
+        return;
+    }
+
+    if (Search::isMateScore(progress.score)) {
+        int movesToMate = (MATE_SCORE - std::abs(progress.score) + 1) / 2;
+        ImGui::Text("Engine score: %smate in %d", progress.score < 0 ? "-" : "", movesToMate);
+    } else {
+        ImGui::Text("Engine score: %+.2f", progress.score / 100.0f);
+    }
+    ImGui::Text("Depth: %d/%d", progress.depth, progress.selDepth);
+    ImGui::Text("Nodes: %llu (%llu nps)", static_cast<unsigned long long>(progress.nodes),
+                static_cast<unsigned long long>(progress.nodesPerSecond));
+    ImGui::Text("Hash: %d permille, %.0f%% hits, pawn hash %.1f%% hits", progress.hashfull, progress.ttHitRate * 100.0,
+                progress.pawnHashHitRate * 100.0);
+    ImGui::Text("First-move cutoffs: %.1f%%", progress.firstMoveCutoffRate * 100.0);
+
+    // built into a fixed buffer so a running search does not allocate every frame.
+    char pvText[MAX_PROGRESS_PV * 6 + 1] = {};
+    int length = 0;
+    for (int i = 0; i < progress.pvLength; ++i) {
+        std::string move = progress.pv[i].toString();
+        length += std::snprintf(pvText + length, sizeof(pvText) - length, "%s ", move.c_str());
+    }
+    ImGui::TextWrapped("PV: %s", pvText);
+}
+
+void UI::renderBoardSettings() {
+    if (!ImGui::CollapsingHeader("Boards")) {
+        return;
     }
-}
\ No newline at end of file
+
+    int gameCount = m_chess->getGameCount();
+    if (ImGui::SliderInt("Games", &gameCount, 1, MAX_GAMES)) {
+        m_chess->setGameCount(gameCount);
+    }
+
+    BoardView view = m_chess->getBoardView();
+    if (ImGui::RadioButton("Single", view == BoardView::SINGLE)) {
+        m_chess->setBoardView(BoardView::SINGLE);
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Grid", view == BoardView::GRID)) {
+        m_chess->setBoardView(BoardView::GRID);
+    }
+}
+
+void UI::renderFrameStats() {
+    if (!ImGui::CollapsingHeader("Performance")) {
+        return;
+    }
+
+    bool onDemand = m_chess->getRenderMode() == RenderMode::ON_DEMAND;
+    if (ImGui::Checkbox("Redraw only on change", &onDemand)) {
+        m_chess->setRenderMode(onDemand ? RenderMode::ON_DEMAND : RenderMode::CONTINUOUS);
+    }
+
+    // sampled over the last second the loop was running, so while idle this shows the
+    // figures from just before the frame it appears in.
+    const FrameStats& stats = m_chess->getFrameStats();
+    ImGui::Text("First frame after: %.0f ms", stats.startupMs);
+    ImGui::Text("Frames rendered: %llu", static_cast<unsigned long long>(stats.framesRendered));
+    ImGui::Text("Frame rate: %.1f fps", stats.framesPerSecond);
+    ImGui::Text("Main thread idle: %.1f%%", stats.idlePercent);
+    ImGui::Text("Board draw calls: %d", m_chess->getBoardRenderer().getDrawCalls());
+}
+
+void UI::renderProfiler() {
+#ifdef CHESS_PROFILER
+    ImGui::SetNextWindowSize(ImVec2(360, 520), ImGuiCond_Once);
+    ImGui::SetNextWindowPos(ImVec2(900, 20), ImGuiCond_Once);
+    ImGui::Begin("Profiler");
+
+    // with on-demand rendering the plots only move while frames are being drawn.
+    ImGui::TextDisabled("last %d samples; counters are per frame", PROFILER_HISTORY);
+
+    for (const auto& metric : Profiler::getMetrics()) {
+        const bool timer = metric->getKind() == MetricKind::TIMER;
+        const float p50 = metric->getPercentile(0.5f);
+        const float p99 = metric->getPercentile(0.99f);
+
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), timer ? "p50 %.1f us  p99 %.1f us" : "p50 %.0f  p99 %.0f", p50, p99);
+
+        ImGui::TextUnformatted(metric->getName());
+        ImGui::PushID(metric.get());
+        ImGui::PlotLines("##History", metric->getSamples(), metric->getSampleCount(), metric->getOldestSample(), overlay, 0.0f,
+                         std::max(metric->getMaximum(), 1.0f), ImVec2(-1.0f, 40.0f));
+        ImGui::PopID();
+    }
+
+    ImGui::End();
+#endif
+}
@@ -4,19 +4,38 @@
 #include <SDL.h>
 #include <imgui.h>
 
+#include "assets.hpp"
+
 class UI {
 
 public:
-    explicit UI(class Chess* chess);
+    // font is the panel's TTF, read ahead on a worker thread.
+    UI(class Chess* chess, Asset font);
     void renderInterfaces();
 
+    // whether (x, y) was inside the panel when it was last drawn. popups are not included;
+    // imgui reports those through io.WantCaptureMouse.
+    bool isPointerOverInterface(int x, int y) const;
+
 private:
     void renderCurrentPlayerIndicator();
     void renderCapturePieces();
+    void renderPieceImage(const class Piece& piece, const ImVec2& size);
+    void renderEvaluationBar();
+    void renderPromotionPopup();
+    void renderBoardSettings();
+    void renderEngineSettings();
+    void renderFrameStats();
+
+    // timers and counters from profiler.hpp; empty unless built with CHESS_PROFILER.
+    void renderProfiler();
 
 private:
     Chess* m_chess;
+    Asset m_fontData;
     ImFont* m_fontLargeLibreBaskerville;
+    ImVec2 m_panelMin;
+    ImVec2 m_panelMax;
 };
 
 #endif
@@ -0,0 +1,58 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <cstdint>
+
+// random keys for position hashing, generated at compile time from a fixed seed so keys
+// are identical across builds and processes.
+struct ZobristKeys {
+    std::uint64_t pieces[2][6][64];
+    std::uint64_t castling[16];
+    std::uint64_t enPassantFile[8];
+    std::uint64_t sideToMove;
+};
+
+namespace detail {
+
+constexpr std::uint64_t splitMix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    std::uint64_t state = 0x4368657373ULL;
+
+    for (auto& colour : keys.pieces) {
+        for (auto& type : colour) {
+            for (std::uint64_t& key : type) {
+                key = splitMix64(state);
+            }
+        }
+    }
+
+    // castling keys combine per right so that any rights mask hashes consistently.
+    std::uint64_t rightKeys[4] = {splitMix64(state), splitMix64(state), splitMix64(state), splitMix64(state)};
+    for (int rights = 0; rights < 16; ++rights) {
+        for (int bit = 0; bit < 4; ++bit) {
+            if (rights & (1 << bit)) {
+                keys.castling[rights] ^= rightKeys[bit];
+            }
+        }
+    }
+
+    for (std::uint64_t& key : keys.enPassantFile) {
+        key = splitMix64(state);
+    }
+
+    keys.sideToMove = splitMix64(state);
+    return keys;
+}
+
+} // namespace detail
+
+inline constexpr ZobristKeys ZOBRIST = detail::makeZobristKeys();
+
+#endif
@@ -0,0 +1,294 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.hpp"
+#include "evaluate.hpp"
+#include "movelogic.hpp"
+#include "nnue.hpp"
+#include "search.hpp"
+#include "transpositiontable.hpp"
+
+// lazy smp scaling benchmark. every position is searched to a fixed depth from an empty
+// hash table with 1, 2, 4, ... threads, and the time-to-depth and nps of each thread
+// count are compared against the single-threaded run. with --nnue the searches use the
+// network, and the evaluation throughput of both evaluations is measured first.
+
+namespace {
+
+const char* const BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "2r3k1/pp3ppp/4p3/3n4/3P4/P4N2/1P3PPP/2R3K1 w - - 0 1",
+};
+
+struct Options {
+    int depth = 8;
+    int maxThreads = 0;
+    int hashMb = 64;
+    SearchOptions searchOptions;
+    std::string networkPath;
+};
+
+void printUsage() {
+    std::cout << "usage: chess_bench [--depth <n>] [--threads <max>] [--hash <mb>] [--no-null-move] [--no-lmr] [--no-rfp]\n"
+                 "                   [--no-futility] [--no-razoring] [--no-check-extensions] [--nnue <file>]\n"
+                 "  runs the position set at 1, 2, 4, ... threads up to --threads (default: all cores).\n"
+                 "  the --no-* switches turn off one search technique for A/B comparisons.\n"
+                 "  --nnue searches with the network and compares evals/sec against the hand-crafted evaluation.\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--depth" && i + 1 < argc) {
+            options.depth = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.maxThreads = std::atoi(argv[++i]);
+        } else if (arg == "--hash" && i + 1 < argc) {
+            options.hashMb = std::atoi(argv[++i]);
+        } else if (arg == "--no-null-move") {
+            options.searchOptions.nullMove = false;
+        } else if (arg == "--no-lmr") {
+            options.searchOptions.lateMoveReductions = false;
+        } else if (arg == "--no-rfp") {
+            options.searchOptions.reverseFutility = false;
+        } else if (arg == "--no-futility") {
+            options.searchOptions.futility = false;
+        } else if (arg == "--no-razoring") {
+            options.searchOptions.razoring = false;
+        } else if (arg == "--no-check-extensions") {
+            options.searchOptions.checkExtensions = false;
+        } else if (arg == "--nnue" && i + 1 < argc) {
+            options.networkPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.depth > 0 && options.hashMb > 0;
+}
+
+struct BenchRun {
+    int threads;
+    double seconds;
+    std::uint64_t nodes;
+    OrderingStats orderingStats;
+    TTStats ttStats;
+    TTStats pawnHashStats;
+
+    // sum over positions of log(nodes), for the geometric-mean branching factor.
+    double logNodes;
+};
+
+BenchRun runBench(int threads, const Options& options) {
+    TranspositionTable transpositionTable;
+    transpositionTable.resize(options.hashMb);
+
+    Search search(transpositionTable);
+    search.setThreadCount(threads);
+    search.setOptions(options.searchOptions);
+
+    SearchLimits limits;
+    limits.depth = options.depth;
+
+    BenchRun run = {threads, 0.0, 0, {}, {}, {}, 0.0};
+
+    for (const char* fen : BENCH_POSITIONS) {
+        Board board;
+        board.setFromFen(fen);
+
+        // each position starts cold so the runs do not feed each other.
+        transpositionTable.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        search.prepare(limits);
+        SearchResult result = search.run(board, limits);
+        run.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        run.nodes += result.nodes;
+        run.logNodes += std::log(static_cast<double>(std::max<std::uint64_t>(result.nodes, 1)));
+        run.orderingStats.cutoffs += result.orderingStats.cutoffs;
+        run.orderingStats.firstMoveCutoffs += result.orderingStats.firstMoveCutoffs;
+        run.ttStats.probes += result.ttStats.probes;
+        run.ttStats.hits += result.ttStats.hits;
+        run.pawnHashStats.probes += result.pawnHashStats.probes;
+        run.pawnHashStats.hits += result.pawnHashStats.hits;
+    }
+
+    return run;
+}
+
+// effective branching factor: the b with b^depth nodes, averaged geometrically over the set.
+double getBranchingFactor(const BenchRun& run, int depth) {
+    return std::exp(run.logNodes / std::size(BENCH_POSITIONS) / depth);
+}
+
+// random playouts from the bench positions, replayed identically for every evaluator.
+struct EvalLine {
+    const char* fen;
+    std::vector<Move> moves;
+};
+
+std::vector<EvalLine> makeEvalLines() {
+    constexpr int LINES_PER_POSITION = 16;
+    constexpr int LINE_LENGTH = 64;
+
+    std::mt19937 random(12345);
+    std::vector<EvalLine> lines;
+
+    for (const char* fen : BENCH_POSITIONS) {
+        for (int line = 0; line < LINES_PER_POSITION; ++line) {
+            Board board;
+            board.setFromFen(fen);
+            EvalLine evalLine = {fen, {}};
+
+            for (int ply = 0; ply < LINE_LENGTH; ++ply) {
+                MoveList moves;
+                MoveLogic::generateLegalMoves(board, moves);
+                if (moves.empty()) {
+                    break;
+                }
+                Move move = moves[random() % moves.size()];
+                UndoInfo undo;
+                board.makeMove(move, undo);
+                evalLine.moves.push_back(move);
+            }
+            lines.push_back(std::move(evalLine));
+        }
+    }
+    return lines;
+}
+
+// evaluations per second over the lines, make and unmake included. network null measures the
+// hand-crafted evaluation (with its pawn hash, as in the search).
+double measureEvalsPerSecond(const std::vector<EvalLine>& lines, const NnueNetwork* network) {
+    constexpr int ROUNDS = 20;
+
+    PawnHashTable pawnTable;
+    auto accumulators = std::make_unique<NnueAccumulatorStack>();
+    std::vector<UndoInfo> undos;
+    std::uint64_t evals = 0;
+    std::int64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (const EvalLine& line : lines) {
+            Board board;
+            board.setFromFen(line.fen);
+            if (network) {
+                accumulators->reset(*network, board);
+            }
+
+            undos.resize(line.moves.size());
+            for (std::size_t i = 0; i < line.moves.size(); ++i) {
+                board.makeMove(line.moves[i], undos[i]);
+                if (network) {
+                    accumulators->push(board, line.moves[i], undos[i]);
+                    checksum += accumulators->evaluate(*network, board);
+                } else {
+                    checksum += evaluate(board, pawnTable);
+                }
+                ++evals;
+            }
+            for (std::size_t i = line.moves.size(); i-- > 0;) {
+                board.unmakeMove(line.moves[i], undos[i]);
+                if (network) {
+                    accumulators->pop();
+                }
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // keeps the evaluations from being optimised away.
+    if (checksum == 0x7FFFFFFFFFFFFFFF) {
+        std::cout << checksum << std::endl;
+    }
+    return seconds > 0 ? evals / seconds : 0.0;
+}
+
+void runEvalBench(const NnueNetwork& network) {
+    std::vector<EvalLine> lines = makeEvalLines();
+    SimdLevel supported = getSupportedSimdLevel();
+
+    std::cout << "evals/sec, make and unmake included" << std::endl;
+    std::cout << "  hand-crafted    " << std::setw(12) << static_cast<std::uint64_t>(measureEvalsPerSecond(lines, nullptr))
+              << std::endl;
+
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2}) {
+        if (level > supported) {
+            break;
+        }
+        setSimdLevel(level);
+        std::cout << "  nnue " << std::left << std::setw(10) << getSimdLevelName(level) << std::right << " " << std::setw(12)
+                  << static_cast<std::uint64_t>(measureEvalsPerSecond(lines, &network)) << std::endl;
+    }
+    setSimdLevel(supported);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    NnueNetwork network;
+    if (!options.networkPath.empty()) {
+        if (!network.load(options.networkPath)) {
+            return 1;
+        }
+        options.searchOptions.network = &network;
+        runEvalBench(network);
+    }
+
+    int maxThreads = options.maxThreads > 0 ? options.maxThreads : static_cast<int>(std::thread::hardware_concurrency());
+    maxThreads = std::max(maxThreads, 1);
+
+    std::cout << "depth " << options.depth << ", hash " << options.hashMb << " MB, " << std::size(BENCH_POSITIONS)
+              << " positions, " << (options.searchOptions.network ? "nnue" : "hand-crafted") << " evaluation" << std::endl;
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    BenchRun baseline = {};
+    for (int threads : threadCounts) {
+        BenchRun run = runBench(threads, options);
+        if (threads == 1) {
+            baseline = run;
+        }
+
+        std::uint64_t nps = static_cast<std::uint64_t>(run.seconds > 0 ? run.nodes / run.seconds : 0);
+        std::uint64_t baselineNps = static_cast<std::uint64_t>(baseline.seconds > 0 ? baseline.nodes / baseline.seconds : 0);
+
+        std::cout << "threads " << std::setw(3) << threads << "  time-to-depth " << std::fixed << std::setprecision(3)
+                  << run.seconds << "s  nodes " << std::setw(12) << run.nodes << "  nps " << std::setw(10) << nps
+                  << "  speedup " << std::setprecision(2) << (run.seconds > 0 ? baseline.seconds / run.seconds : 0.0)
+                  << "x  nps scaling " << (baselineNps ? static_cast<double>(nps) / baselineNps : 0.0) << "x  first-move cutoffs "
+                  << std::setprecision(1) << run.orderingStats.getFirstMoveCutoffRate() * 100.0 << "%  ebf " << std::setprecision(2)
+                  << getBranchingFactor(run, options.depth) << "  tt hits " << std::setprecision(1)
+                  << run.ttStats.getHitRate() * 100.0 << "%  pawn hash hits " << run.pawnHashStats.getHitRate() * 100.0 << "%"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "nnue.hpp"
+#include "psqt.hpp"
+
+// writes a bootstrap network for the NNUE evaluation. it reproduces the material + piece-square
+// part of the hand-crafted evaluation (middlegame and endgame averaged), which makes it a sane
+// starting point for training and a known-good file for testing the inference code.
+
+namespace {
+
+// the accumulator starts each neuron half way up the clipped range, so it can move both ways.
+constexpr std::int16_t NEURON_BIAS = 64;
+
+// centipawns per unit summed over all neurons of one perspective.
+constexpr int VALUE_DIVISOR = 32;
+
+void printUsage() {
+    std::cout << "usage: chess_makenet <output file>\n"
+                 "  writes a network equivalent to the material + piece-square evaluation.\n";
+}
+
+// the feature's value seen from its perspective: own pieces positive, the opponent's negative.
+int getFeatureValue(int feature) {
+    int relativeSquare = feature % 64;
+    int piece = feature / 64 % 6;
+    int relativeColour = feature / 384 % 2;
+
+    // both perspectives see the same value, so white's perspective is enough.
+    Score score = getPieceSquareScore(relativeColour, piece, relativeSquare);
+    return (score.mg + score.eg) / 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        printUsage();
+        return 2;
+    }
+
+    NnueHeader header = {};
+    std::memcpy(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC));
+    header.version = NNUE_VERSION;
+    header.inputs = NNUE_INPUTS;
+    header.hidden = NNUE_HIDDEN;
+
+    // the output sums NNUE_HIDDEN / VALUE_DIVISOR units per centipawn from both perspectives.
+    header.outputScale = NNUE_WEIGHT_SCALE * VALUE_DIVISOR / (2 * NNUE_HIDDEN);
+
+    std::vector<std::int16_t> featureBiases(NNUE_HIDDEN, NEURON_BIAS);
+    std::vector<std::int8_t> featureWeights(static_cast<std::size_t>(NNUE_INPUTS) * NNUE_HIDDEN);
+    std::vector<std::int8_t> outputWeights(2 * NNUE_HIDDEN);
+    std::int32_t outputBias = 0;
+
+    // each feature's value is spread over every neuron, the remainder rotated by feature so
+    // rounding does not pile up on the same neurons.
+    for (int feature = 0; feature < NNUE_INPUTS; ++feature) {
+        int total = getFeatureValue(feature) * NNUE_HIDDEN / VALUE_DIVISOR;
+        int base = total >= 0 ? total / NNUE_HIDDEN : -((-total + NNUE_HIDDEN - 1) / NNUE_HIDDEN);
+        int remainder = total - base * NNUE_HIDDEN;
+        int offset = feature * 97 % NNUE_HIDDEN;
+
+        for (int neuron = 0; neuron < NNUE_HIDDEN; ++neuron) {
+            int extra = (neuron + offset) % NNUE_HIDDEN < remainder ? 1 : 0;
+            featureWeights[static_cast<std::size_t>(feature) * NNUE_HIDDEN + neuron] = static_cast<std::int8_t>(base + extra);
+        }
+    }
+
+    for (int neuron = 0; neuron < NNUE_HIDDEN; ++neuron) {
+        outputWeights[neuron] = 1;
+        outputWeights[NNUE_HIDDEN + neuron] = -1;
+    }
+
+    std::ofstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(featureBiases.data()), featureBiases.size() * sizeof(std::int16_t));
+    file.write(reinterpret_cast<const char*>(featureWeights.data()), featureWeights.size());
+    file.write(reinterpret_cast<const char*>(outputWeights.data()), outputWeights.size());
+    file.write(reinterpret_cast<const char*>(&outputBias), sizeof(outputBias));
+
+    std::cout << "wrote " << argv[1] << std::endl;
+    return file ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "allocationcounter.hpp"
+#include "attacks.hpp"
+#include "board.hpp"
+#include "perft.hpp"
+
+// headless perft runner. without --fen it runs the standard reference positions and exits
+// non-zero on a node-count mismatch or a heap allocation in the generator, so it doubles
+// as the move generator's correctness and throughput gate.
+
+namespace {
+
+struct PerftPosition {
+    const char* name;
+    const char* fen;
+    int depth;
+    std::uint64_t expectedNodes;
+};
+
+const PerftPosition REFERENCE_POSITIONS[] = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6, 119060324ULL},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690ULL},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 7, 178633661ULL},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292ULL},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194ULL},
+    {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551ULL},
+};
+
+struct Options {
+    std::vector<std::string> fens;
+    int depth = 0;
+    bool bulkCount = true;
+    bool divide = false;
+};
+
+void printUsage() {
+    std::cout << "usage: chess_perft [--fen <fen>]... [--depth <n>] [--divide] [--no-bulk]\n"
+                 "  without --fen the reference suite is run and checked against known node counts.\n"
+                 "  --depth overrides the suite depth (counts are then reported, not checked).\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--fen" && i + 1 < argc) {
+            options.fens.push_back(argv[++i]);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            char* end = nullptr;
+            long depth = std::strtol(argv[++i], &end, 10);
+            if (*end != '\0' || depth < 1 || depth > 64) {
+                std::cerr << "Invalid depth: " << argv[i] << std::endl;
+                return false;
+            }
+            options.depth = static_cast<int>(depth);
+        } else if (arg == "--divide") {
+            options.divide = true;
+        } else if (arg == "--no-bulk") {
+            options.bulkCount = false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// counts the nodes, printing nodes, time, nodes/sec and optionally the divide. false if the
+// FEN does not parse.
+bool runPerft(const std::string& name, const std::string& fen, int depth, const Options& options, std::uint64_t& nodes,
+              std::uint64_t& allocations) {
+    nodes = 0;
+
+    Board board;
+    if (!board.setFromFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return false;
+    }
+
+    std::vector<PerftDivide> divide;
+
+    auto start = std::chrono::steady_clock::now();
+    AllocationScope scope;
+    if (options.divide) {
+        // the divide's own list is the one allocation expected; the tree under it is not.
+        divide = perftDivide(board, depth, options.bulkCount);
+        for (const PerftDivide& entry : divide) {
+            nodes += entry.nodes;
+        }
+        allocations += scope.getAllocations() - (divide.capacity() > 0 ? 1 : 0);
+    } else {
+        nodes = perft(board, depth, options.bulkCount);
+        allocations += scope.getAllocations();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const PerftDivide& entry : divide) {
+        std::cout << "  " << entry.move.toString() << ": " << entry.nodes << "\n";
+    }
+
+    std::cout << std::left << std::setw(10) << name << " depth " << depth << "  nodes " << std::setw(12) << nodes << " time "
+              << std::fixed << std::setprecision(3) << seconds << "s  nps "
+              << static_cast<std::uint64_t>(seconds > 0 ? nodes / seconds : 0) << std::endl;
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::cout << "slider lookups: " << (isUsingPext() ? "pext" : "magic") << ", leaf counting: "
+              << (options.bulkCount ? "bulk" : "make/unmake") << std::endl;
+
+    std::uint64_t totalNodes = 0;
+    std::uint64_t allocations = 0;
+    bool failed = false;
+    auto start = std::chrono::steady_clock::now();
+
+    if (!options.fens.empty()) {
+        int depth = options.depth > 0 ? options.depth : 5;
+        for (const std::string& fen : options.fens) {
+            std::uint64_t nodes = 0;
+            if (!runPerft("fen", fen, depth, options, nodes, allocations)) {
+                failed = true;
+            }
+            totalNodes += nodes;
+        }
+    } else {
+        for (const PerftPosition& position : REFERENCE_POSITIONS) {
+            int depth = options.depth > 0 ? options.depth : position.depth;
+            std::uint64_t nodes = 0;
+            if (!runPerft(position.name, position.fen, depth, options, nodes, allocations)) {
+                failed = true;
+            }
+            totalNodes += nodes;
+
+            if (depth == position.depth && nodes != position.expectedNodes) {
+                std::cerr << "MISMATCH in " << position.name << ": expected " << position.expectedNodes << ", got " << nodes
+                          << std::endl;
+                failed = true;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "total nodes " << totalNodes << "  nps " << static_cast<std::uint64_t>(seconds > 0 ? totalNodes / seconds : 0)
+              << "  heap allocations during perft " << allocations << std::endl;
+
+    if (allocations != 0) {
+        std::cerr << "move generation allocated on the heap" << std::endl;
+        failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
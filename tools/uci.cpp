@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.hpp"
+#include "movelogic.hpp"
+#include "nnue.hpp"
+#include "search.hpp"
+#include "searchservice.hpp"
+#include "transpositiontable.hpp"
+
+// uci front end for the engine. a reader thread does nothing but move stdin lines into a
+// queue; the main thread owns the position and the search service, handles commands and,
+// while a search runs, polls it for progress and the best move between them. the search
+// itself runs on the service's thread and never waits on input or output.
+
+namespace {
+
+const char* const START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+constexpr int DEFAULT_HASH_MB = 16;
+constexpr int MAX_HASH_MB = 32768;
+constexpr int MAX_THREADS = 256;
+
+// how often the main thread looks for search output while a search is running.
+constexpr int POLL_INTERVAL_MS = 2;
+
+// kept back from the clock for the time it takes the move to reach the gui.
+constexpr int MOVE_OVERHEAD_MS = 30;
+
+// with no movestogo, plan as if this many moves were left until the next time control.
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+
+// lines from stdin, read on their own thread so the main thread can keep polling the
+// search. end of input reads as "quit".
+class InputQueue {
+public:
+    InputQueue()
+        : m_thread(&InputQueue::readLoop, this) {}
+
+    ~InputQueue() {
+        m_thread.join();
+    }
+
+    // waits up to timeoutMs (forever if negative) for a line; false if none arrived.
+    bool pop(std::string& line, int timeoutMs) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto ready = [this] { return !m_lines.empty(); };
+
+        if (timeoutMs < 0) {
+            m_condition.wait(lock, ready);
+        } else if (!m_condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+            return false;
+        }
+
+        line = std::move(m_lines.front());
+        m_lines.pop_front();
+        return true;
+    }
+
+private:
+    // stops after "quit", so the thread can be joined instead of being left blocked in a read.
+    void readLoop() {
+        std::string line;
+        while (true) {
+            bool quit = !std::getline(std::cin, line);
+            if (quit) {
+                line = "quit";
+            } else {
+                std::istringstream stream(line);
+                std::string command;
+                stream >> command;
+                quit = command == "quit";
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_lines.push_back(line);
+            }
+            m_condition.notify_one();
+
+            if (quit) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::string> m_lines;
+    std::thread m_thread;
+};
+
+struct GoParameters {
+    int depth = 0;
+    int moveTimeMs = 0;
+    std::uint64_t nodes = 0;
+    int time[2] = {0, 0};
+    int increment[2] = {0, 0};
+    int movesToGo = 0;
+    bool ponder = false;
+    bool infinite = false;
+};
+
+class UciEngine {
+public:
+    UciEngine();
+
+    void run();
+
+private:
+    // false once the engine should exit.
+    bool handleCommand(const std::string& line);
+
+    void handleSetOption(std::istringstream& stream);
+    void handlePosition(std::istringstream& stream);
+    void handleGo(std::istringstream& stream);
+    void handleStop();
+
+    // stops any running search and reports its best move before the next command is handled.
+    void finishSearch();
+    void pollSearch();
+
+    void reportProgress(const SearchProgress& progress) const;
+    void reportBestMove(const SearchResult& result);
+
+    SearchLimits getLimits(const GoParameters& go) const;
+
+private:
+    TranspositionTable m_transpositionTable;
+    NnueNetwork m_network;
+    SearchService m_searchService;
+    SearchOptions m_options;
+    Board m_board;
+
+    // a search was started and its best move has not been sent yet.
+    bool m_searchActive;
+
+    // "go infinite" must not answer before "stop", even if the search ends on its own.
+    bool m_infinite;
+    bool m_stopReceived;
+    bool m_resultHeld;
+    SearchResult m_heldResult;
+};
+
+UciEngine::UciEngine()
+    : m_searchService(m_transpositionTable)
+    , m_searchActive(false)
+    , m_infinite(false)
+    , m_stopReceived(false)
+    , m_resultHeld(false) {
+    m_transpositionTable.resize(DEFAULT_HASH_MB);
+    m_board.setFromFen(START_FEN);
+}
+
+void UciEngine::run() {
+    InputQueue input;
+
+    while (true) {
+        std::string line;
+        if (input.pop(line, m_searchActive ? POLL_INTERVAL_MS : -1) && !handleCommand(line)) {
+            break;
+        }
+
+        if (m_searchActive) {
+            pollSearch();
+        }
+    }
+
+    finishSearch();
+}
+
+bool UciEngine::handleCommand(const std::string& line) {
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+
+    if (command.empty()) {
+        return true;
+    }
+
+    if (command == "uci") {
+        std::cout << "id name Chess\n"
+                  << "id author jonahwoodley\n"
+                  << "option name Hash type spin default " << DEFAULT_HASH_MB << " min 1 max " << MAX_HASH_MB << "\n"
+                  << "option name Threads type spin default 1 min 1 max " << MAX_THREADS << "\n"
+                  << "option name MultiPV type spin default 1 min 1 max " << MAX_PROGRESS_LINES << "\n"
+                  << "option name Ponder type check default false\n"
+                  << "option name EvalFile type string default <empty>\n"
+                  << "option name Clear Hash type button\n"
+                  << "uciok" << std::endl;
+    } else if (command == "isready") {
+        // answered straight away, also while searching.
+        std::cout << "readyok" << std::endl;
+    } else if (command == "setoption") {
+        finishSearch();
+        handleSetOption(stream);
+    } else if (command == "ucinewgame") {
+        finishSearch();
+        m_transpositionTable.clear();
+    } else if (command == "position") {
+        finishSearch();
+        handlePosition(stream);
+    } else if (command == "go") {
+        finishSearch();
+        handleGo(stream);
+    } else if (command == "stop") {
+        handleStop();
+    } else if (command == "ponderhit") {
+        m_searchService.ponderHit();
+    } else if (command == "quit") {
+        return false;
+    } else if (command == "debug" || command == "register") {
+        // nothing to do.
+    } else {
+        std::cout << "info string unknown command " << command << std::endl;
+    }
+
+    return true;
+}
+
+void UciEngine::handleSetOption(std::istringstream& stream) {
+    // "setoption name <id> [value <x>]", where both the name and the value may contain spaces.
+    std::string token;
+    std::string name;
+    std::string value;
+    std::string* target = nullptr;
+
+    while (stream >> token) {
+        if (token == "name") {
+            target = &name;
+        } else if (token == "value") {
+            target = &value;
+        } else if (target) {
+            *target += (target->empty() ? "" : " ") + token;
+        }
+    }
+
+    if (name == "Hash") {
+        m_transpositionTable.resize(std::clamp(std::atoi(value.c_str()), 1, MAX_HASH_MB));
+    } else if (name == "Threads") {
+        m_searchService.setThreadCount(std::clamp(std::atoi(value.c_str()), 1, MAX_THREADS));
+    } else if (name == "MultiPV") {
+        m_options.multiPv = std::clamp(std::atoi(value.c_str()), 1, MAX_PROGRESS_LINES);
+    } else if (name == "Ponder") {
+        // the gui decides when to ponder; nothing changes on the engine side.
+    } else if (name == "EvalFile") {
+        m_network.unload();
+        if (!value.empty() && value != "<empty>") {
+            if (m_network.load(value)) {
+                std::cout << "info string using network " << value << std::endl;
+            } else {
+                std::cout << "info string could not load " << value << ", using the hand-crafted evaluation" << std::endl;
+            }
+        }
+        m_options.network = m_network.isLoaded() ? &m_network : nullptr;
+    } else if (name == "Clear Hash") {
+        m_transpositionTable.clear();
+    } else {
+        std::cout << "info string unknown option " << name << std::endl;
+    }
+}
+
+void UciEngine::handlePosition(std::istringstream& stream) {
+    std::string token;
+    stream >> token;
+
+    std::string fen;
+    if (token == "startpos") {
+        fen = START_FEN;
+        stream >> token;
+    } else if (token == "fen") {
+        while (stream >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    } else {
+        return;
+    }
+
+    if (!m_board.setFromFen(fen)) {
+        std::cout << "info string invalid fen " << fen << std::endl;
+        m_board.setFromFen(START_FEN);
+        return;
+    }
+
+    if (token != "moves") {
+        return;
+    }
+
+    // the moves are played on the board rather than set up, so the search sees the
+    // positions before them for repetition draws.
+    while (stream >> token) {
+        MoveList moves;
+        MoveLogic::generateLegalMoves(m_board, moves);
+
+        auto found = std::find_if(moves.begin(), moves.end(), [&token](Move move) { return move.toString() == token; });
+        if (found == moves.end()) {
+            std::cout << "info string illegal move " << token << std::endl;
+            return;
+        }
+
+        UndoInfo undo;
+        m_board.makeMove(*found, undo);
+    }
+}
+
+void UciEngine::handleGo(std::istringstream& stream) {
+    GoParameters go;
+    std::string token;
+
+    while (stream >> token) {
+        if (token == "depth") {
+            stream >> go.depth;
+        } else if (token == "movetime") {
+            stream >> go.moveTimeMs;
+        } else if (token == "nodes") {
+            stream >> go.nodes;
+        } else if (token == "wtime") {
+            stream >> go.time[0];
+        } else if (token == "btime") {
+            stream >> go.time[1];
+        } else if (token == "winc") {
+            stream >> go.increment[0];
+        } else if (token == "binc") {
+            stream >> go.increment[1];
+        } else if (token == "movestogo") {
+            stream >> go.movesToGo;
+        } else if (token == "ponder") {
+            go.ponder = true;
+        } else if (token == "infinite") {
+            go.infinite = true;
+        }
+    }
+
+    m_infinite = go.infinite;
+    m_stopReceived = false;
+    m_resultHeld = false;
+    m_searchActive = true;
+
+    m_searchService.setOptions(m_options);
+    m_searchService.start(m_board, getLimits(go));
+}
+
+void UciEngine::handleStop() {
+    m_stopReceived = true;
+    m_searchService.stop();
+
+    if (m_resultHeld) {
+        m_resultHeld = false;
+        reportBestMove(m_heldResult);
+    }
+}
+
+void UciEngine::finishSearch() {
+    if (!m_searchActive) {
+        return;
+    }
+
+    handleStop();
+    while (m_searchActive) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pollSearch();
+    }
+}
+
+void UciEngine::pollSearch() {
+    SearchProgress progress;
+    if (m_searchService.pollProgress(progress)) {
+        reportProgress(progress);
+    }
+
+    SearchResult result;
+    if (!m_searchService.pollResult(result)) {
+        return;
+    }
+
+    if (m_infinite && !m_stopReceived) {
+        m_heldResult = result;
+        m_resultHeld = true;
+        return;
+    }
+    reportBestMove(result);
+}
+
+void UciEngine::reportProgress(const SearchProgress& progress) const {
+    for (int i = 0; i < progress.lineCount; ++i) {
+        const ProgressLine& line = progress.lines[i];
+
+        std::cout << "info depth " << progress.depth << " seldepth " << progress.selDepth << " multipv " << i + 1;
+
+        if (Search::isMateScore(line.score)) {
+            int movesToMate = (MATE_SCORE - std::abs(line.score) + 1) / 2;
+            std::cout << " score mate " << (line.score < 0 ? -movesToMate : movesToMate);
+        } else {
+            std::cout << " score cp " << line.score;
+        }
+
+        std::cout << " nodes " << progress.nodes << " nps " << progress.nodesPerSecond << " hashfull " << progress.hashfull
+                  << " time " << progress.elapsedMs << " pv";
+
+        for (int j = 0; j < line.pvLength; ++j) {
+            std::cout << ' ' << line.pv[j].toString();
+        }
+        std::cout << '\n';
+    }
+    std::cout << std::flush;
+}
+
+void UciEngine::reportBestMove(const SearchResult& result) {
+    m_searchActive = false;
+
+    // no legal moves: the gui should not have asked, but it still needs an answer.
+    if (result.bestMove.isNull()) {
+        std::cout << "bestmove 0000" << std::endl;
+        return;
+    }
+
+    std::cout << "bestmove " << result.bestMove.toString();
+    if (!result.ponderMove.isNull()) {
+        std::cout << " ponder " << result.ponderMove.toString();
+    }
+    std::cout << std::endl;
+}
+
+// with a clock, the move gets an even share of the time left until the next time control
+// plus most of the increment. the search treats this as a hard limit and does not start
+// an iteration past half of it, so most moves finish well inside it.
+SearchLimits UciEngine::getLimits(const GoParameters& go) const {
+    SearchLimits limits;
+    limits.depth = go.depth;
+    limits.nodes = go.nodes;
+    limits.ponder = go.ponder;
+
+    if (go.infinite) {
+        return limits;
+    }
+
+    const int side = colourIndex(m_board.getSideToMove());
+    if (go.moveTimeMs > 0) {
+        limits.moveTimeMs = go.moveTimeMs;
+    } else if (go.time[side] > 0) {
+        const int movesToGo = go.movesToGo > 0 ? go.movesToGo : DEFAULT_MOVES_TO_GO;
+        // 0 would mean no limit, so a nearly flagged clock still gets a millisecond, and never
+        // more than the clock minus the overhead.
+        const int available = std::max(go.time[side] - MOVE_OVERHEAD_MS, 1);
+        limits.moveTimeMs = std::max(std::min(go.time[side] / movesToGo + go.increment[side] * 3 / 4, available), 1);
+    }
+
+    return limits;
+}
+
+} // namespace
+
+int main() {
+    UciEngine engine;
+    engine.run();
+    return 0;
+}